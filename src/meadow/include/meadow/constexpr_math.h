@@ -0,0 +1,155 @@
+#pragma once
+
+#include <limits>
+#include <numbers>
+
+// Replacements of <cmath> and <complex> functions that can be evaluated at compile time, for designing filters and
+// tables in constant expressions. Accurate to a few ulps for the moderate arguments these are meant for, prefer the
+// standard functions at runtime.
+namespace cx
+{
+
+constexpr double abs(double x)
+{
+    return x < 0 ? -x : x;
+}
+
+// Precond: x >= 0.
+constexpr double sqrt(double x)
+{
+    if (x <= 0 || x != x || x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+    // Newton's iteration decreases monotonically from any starting point above the root, stop when it doesn't.
+    double y = x > 1 ? x : 1;
+    for (;;) {
+        const double next = (y + x / y) / 2;
+        if (next >= y) {
+            return y;
+        }
+        y = next;
+    }
+}
+
+namespace detail
+{
+// Taylor series of sin (odd = true) or cos (odd = false) for |x| <= pi/4.
+constexpr double sin_cos_series(double x, bool odd)
+{
+    const double x2 = x * x;
+    double term = odd ? x : 1, sum = term;
+    for (int k = odd ? 2 : 1; term != 0; k += 2) {
+        term *= -x2 / (k * (k + 1));
+        const double next = sum + term;
+        if (next == sum) {
+            break;
+        }
+        sum = next;
+    }
+    return sum;
+}
+
+// sin(x) for quadrant = 0, cos(x) for quadrant = 1, after reducing x to [-pi/4, pi/4] by multiples of pi/2.
+constexpr double sin_quadrant(double x, long long quadrant)
+{
+    // pi/2 = half_pi_hi + half_pi_lo, subtracting the two parts separately keeps r accurate (Cody-Waite).
+    constexpr double half_pi_hi = std::numbers::pi / 2;
+    constexpr double half_pi_lo = 6.123233995736766e-17;
+    const double kf = x / half_pi_hi;
+    const long long k = kf < 0 ? static_cast<long long>(kf - 0.5) : static_cast<long long>(kf + 0.5);
+    const double r = (x - static_cast<double>(k) * half_pi_hi) - static_cast<double>(k) * half_pi_lo;
+    switch (((k + quadrant) % 4 + 4) % 4) {
+    case 0:
+        return sin_cos_series(r, true);
+    case 1:
+        return sin_cos_series(r, false);
+    case 2:
+        return -sin_cos_series(r, true);
+    default:
+        return -sin_cos_series(r, false);
+    }
+}
+} // namespace detail
+
+constexpr double sin(double x)
+{
+    return detail::sin_quadrant(x, 0);
+}
+
+constexpr double cos(double x)
+{
+    return detail::sin_quadrant(x, 1);
+}
+
+constexpr double tan(double x)
+{
+    return sin(x) / cos(x);
+}
+
+// Minimal complex number usable in constant expressions.
+struct complex {
+    double re = 0, im = 0;
+
+    constexpr complex() = default;
+    constexpr complex(double re_arg, double im_arg = 0)
+        : re(re_arg)
+        , im(im_arg)
+    {
+    }
+
+    friend constexpr complex operator+(complex x, complex y)
+    {
+        return {x.re + y.re, x.im + y.im};
+    }
+    friend constexpr complex operator-(complex x, complex y)
+    {
+        return {x.re - y.re, x.im - y.im};
+    }
+    friend constexpr complex operator-(complex x)
+    {
+        return {-x.re, -x.im};
+    }
+    friend constexpr complex operator*(complex x, complex y)
+    {
+        return {x.re * y.re - x.im * y.im, x.re * y.im + x.im * y.re};
+    }
+    friend constexpr complex operator/(complex x, complex y)
+    {
+        const double d = y.re * y.re + y.im * y.im;
+        return {(x.re * y.re + x.im * y.im) / d, (x.im * y.re - x.re * y.im) / d};
+    }
+    friend constexpr bool operator==(complex x, complex y) = default;
+};
+
+constexpr complex conj(complex z)
+{
+    return {z.re, -z.im};
+}
+
+constexpr double abs(complex z)
+{
+    return sqrt(z.re * z.re + z.im * z.im);
+}
+
+// exp(i * angle)
+constexpr complex unit_polar(double angle)
+{
+    return {cos(angle), sin(angle)};
+}
+
+// Principal square root, the branch cut is the negative real axis.
+constexpr complex sqrt(complex z)
+{
+    if (z.re == 0 && z.im == 0) {
+        return {};
+    }
+    const double r = abs(z);
+    if (z.re >= 0) {
+        const double t = sqrt((r + z.re) / 2);
+        return {t, z.im / (2 * t)};
+    }
+    const double t = sqrt((r - z.re) / 2);
+    return {abs(z.im) / (2 * t), z.im < 0 ? -t : t};
+}
+
+} // namespace cx
@@ -233,6 +233,31 @@ pair<I, T> ifloor_frac(T x)
     return pair(detail::float_to_int_cast_core<I>(integral), x - integral);
 }
 
+namespace detail
+{
+// Count, means and sums of the squared and cross deviations from the means of samples of x and y, and the minimum and
+// maximum of x. The kernel of `RunningStat::add` and of `matlab::var`, `cov`, `corr` and `describe`.
+struct DeviationSums {
+    double n = 0;
+    double mean_x = 0, mean_y = 0;
+    double sxx = 0, sxy = 0, syy = 0;
+    double min_x = INFINITY, max_x = -INFINITY;
+};
+
+// Samples per block of `deviation_sums`.
+constexpr size_t k_deviation_sums_block = 512;
+
+// Chan et al.'s update: the deviation sums of the union of two disjoint sets.
+DeviationSums merge_deviation_sums(const DeviationSums& a, const DeviationSums& b);
+
+// Deviation sums of xs, and of ys unless it is empty, in a single pass over the memory. Each block is read twice
+// while it is in L1, summing in independent lanes (vectorized): the means, then the deviations from them with the
+// correction term that cancels the rounding error of the means. The blocks are merged with their means relative to
+// the first elements, so that they stay accurate even if the data has a large offset.
+// Precond: ys is empty or size(ys) == size(xs).
+DeviationSums deviation_sums(std::span<const double> xs, std::span<const double> ys = {});
+} // namespace detail
+
 enum class VarianceNorm {
     sample,    // Normalize by count() - 1
     population // Normalize by count()
@@ -244,6 +269,11 @@ class RunningStat
 public:
     // Adds a sample. Samples must be finite.
     void operator()(double sample);
+    // Adds the samples, the same as calling operator() on each of them up to rounding. Uses `detail::deviation_sums`,
+    // which sums blocks of samples in independent lanes (vectorized), then merges them.
+    void add(std::span<const double> samples);
+    // Adds the samples of `other`, as if they were added to this one (Chan et al.'s parallel formula).
+    void merge(const RunningStat& other);
     void reset();
 
     NODIS size_t count() const;
@@ -259,9 +289,229 @@ public:
     NODIS double stddev(VarianceNorm norm = VarianceNorm::sample) const;
 
 private:
+    NODIS detail::DeviationSums deviation_sums() const;
+    void assign(size_t count, const detail::DeviationSums& sums);
+
     size_t num_samples = 0;
     double running_mean = 0;
     double sum_sq_dev = 0; // Sum of the squared deviations from the running mean.
     double min_sample = INFINITY;
     double max_sample = -INFINITY;
 };
+
+// Mean, variance, skewness and kurtosis of a continuously sampled process, updated incrementally, without storing the
+// samples. Uses Pebay's update formulas for the sums of the 2nd, 3rd and 4th powers of the deviations from the mean.
+class RunningMoments
+{
+public:
+    // Adds a sample. Samples must be finite.
+    void operator()(double sample);
+    // Adds the samples of `other`, as if they were added to this one.
+    void merge(const RunningMoments& other);
+    void reset();
+
+    NODIS size_t count() const;
+
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double mean() const;
+    // Precond: count() > 1 with VarianceNorm::sample, count() > 0 with VarianceNorm::population. Return NaN if the
+    // precondition is not met.
+    NODIS double var(VarianceNorm norm = VarianceNorm::sample) const;
+    NODIS double stddev(VarianceNorm norm = VarianceNorm::sample) const;
+    // Biased estimates, like MATLAB's `skewness(x)` and `kurtosis(x) - 3`. NaN if the variance is zero.
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double skewness() const;
+    NODIS double excess_kurtosis() const;
+
+private:
+    size_t num_samples = 0;
+    double running_mean = 0;
+    // Sums of the 2nd, 3rd and 4th powers of the deviations from the running mean.
+    double m2 = 0, m3 = 0, m4 = 0;
+};
+
+// RunningStat of `samples`, computed on `n_threads` threads (0 means std::thread::hardware_concurrency()) and merged.
+RunningStat parallel_running_stat(std::span<const double> samples, size_t n_threads = 0);
+
+// Streaming estimate of a fixed set of quantiles in constant memory, the P-square algorithm of Jain and Chlamtac,
+// extended to several quantiles by Raatikainen: 2m + 3 markers track the minimum, the maximum, the m quantiles and the
+// midpoints between them. Exact until 2m + 3 samples are added. The markers of two streams can't be combined, use
+// TDigest to merge estimates.
+class P2Quantiles
+{
+public:
+    // Precond: `ps` is non-empty, increasing, in [0, 1].
+    explicit P2Quantiles(std::span<const double> ps);
+
+    // Adds a sample. Samples must be finite.
+    void operator()(double sample);
+    void add(std::span<const double> samples);
+    void reset();
+
+    NODIS size_t count() const;
+    NODIS size_t num_quantiles() const;
+    // Estimate of the `i`th quantile of the constructor's `ps`.
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double quantile(size_t i) const;
+
+private:
+    std::vector<double> ps;
+    // Per marker: the fraction of the samples below it, its height, and its actual and desired 0-based positions.
+    std::vector<double> fractions, heights, positions, desired;
+    size_t num_samples = 0;
+};
+
+// Streaming estimate of arbitrary quantiles in bounded memory, the merging t-digest of Dunning and Ertl. The samples
+// are clustered into centroids, small near the tails and large near the median, so that the extreme quantiles stay
+// accurate. Samples are buffered and merged into the centroids in sorted batches. Exact while the number of samples
+// is below about `compression` / 2.
+class TDigest
+{
+public:
+    // The digest keeps fewer than `compression` centroids, about 0.6 * `compression` after a full compression.
+    explicit TDigest(double compression = 100);
+
+    // Adds a sample. Samples must be finite.
+    void operator()(double sample);
+    void add(std::span<const double> samples);
+    // Adds the samples of `other`, as if they were added to this one.
+    void merge(const TDigest& other);
+    void reset();
+
+    NODIS size_t count() const;
+    NODIS double min() const;
+    NODIS double max() const;
+    // Estimate of the quantile `p` in [0, 1], interpolating like MATLAB's `quantile`. Merges the buffered samples
+    // first, which doesn't change the samples the digest stands for, so it is const; but unlike the other const
+    // members, it must not be called concurrently on the same digest.
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double quantile(double p) const;
+    NODIS size_t num_centroids() const;
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    // Merges `buffer` into `centroids`.
+    void compress() const;
+
+    double compression;
+    size_t buffer_capacity;
+    // Merged on read by the const accessors.
+    mutable std::vector<Centroid> centroids; // Sorted by mean.
+    mutable std::vector<Centroid> buffer;    // Not yet merged into `centroids`.
+    mutable std::vector<Centroid> scratch;
+    size_t num_samples = 0;
+    double min_sample = INFINITY;
+    double max_sample = -INFINITY;
+};
+
+// Exponentially weighted mean and variance of a continuously sampled process, updated incrementally in O(1): the
+// newest sample has the weight `alpha`, each older one 1 - alpha times the weight of the next, and the first sample
+// has the rest. Like pandas' `ewm(halflife=h, adjust=False)`.
+class EwmStat
+{
+public:
+    // The weight of a sample halves after `halflife` more samples.
+    // Precond: halflife > 0.
+    explicit EwmStat(double halflife);
+
+    // Adds a sample. Samples must be finite.
+    void operator()(double sample);
+    void add(std::span<const double> samples);
+    void reset();
+
+    NODIS size_t count() const;
+    // Weight of the newest sample, 1 - 2^(-1 / halflife).
+    NODIS double alpha() const;
+
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double mean() const;
+    // VarianceNorm::population is the weighted mean of the squared deviations, VarianceNorm::sample corrects its bias
+    // for the effective number of samples, and gives `var` for equal weights.
+    // Precond: count() > 1 with VarianceNorm::sample, count() > 0 with VarianceNorm::population. Return NaN if the
+    // precondition is not met.
+    NODIS double var(VarianceNorm norm = VarianceNorm::sample) const;
+    NODIS double stddev(VarianceNorm norm = VarianceNorm::sample) const;
+
+private:
+    double a;
+    size_t num_samples = 0;
+    double running_mean = 0;
+    double population_var = 0;
+    double sum_sq_weights = 0; // Sum of the squared weights, the weights sum to 1.
+};
+
+// Exponentially weighted means, variances, covariance and correlation of two series, weighted like `EwmStat`.
+class EwmCov
+{
+public:
+    // Precond: halflife > 0.
+    explicit EwmCov(double halflife);
+
+    // Adds a pair of samples. Samples must be finite.
+    void operator()(double x, double y);
+    // Precond: size(xs) == size(ys).
+    void add(std::span<const double> xs, std::span<const double> ys);
+    void reset();
+
+    NODIS size_t count() const;
+
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double mean_x() const;
+    NODIS double mean_y() const;
+    // Precond: count() > 1 with VarianceNorm::sample, count() > 0 with VarianceNorm::population. Return NaN if the
+    // precondition is not met.
+    NODIS double var_x(VarianceNorm norm = VarianceNorm::sample) const;
+    NODIS double var_y(VarianceNorm norm = VarianceNorm::sample) const;
+    NODIS double cov(VarianceNorm norm = VarianceNorm::sample) const;
+    // NaN if either series is constant.
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double corr() const;
+
+private:
+    double a;
+    size_t num_samples = 0;
+    double running_mean_x = 0, running_mean_y = 0;
+    double population_var_x = 0, population_var_y = 0, population_cov = 0;
+    double sum_sq_weights = 0;
+};
+
+// `EwmStat` of several series sampled together, e.g. the returns of many assets per tick. A tick updates all series
+// in one branch-free loop over structure-of-arrays state, which the compiler vectorizes.
+class MultiEwmStat
+{
+public:
+    // Precond: halflife > 0.
+    MultiEwmStat(size_t n_series, double halflife);
+
+    // Adds one sample per series.
+    // Precond: size(samples) == size(). Samples must be finite.
+    void operator()(std::span<const double> samples);
+    // Adds consecutive ticks of size() samples each.
+    // Precond: size(ticks) is a multiple of size().
+    void add(std::span<const double> ticks);
+    void reset();
+
+    // Number of series.
+    NODIS size_t size() const;
+    // Number of ticks added.
+    NODIS size_t count() const;
+
+    // Precond: count() > 0.
+    NODIS std::span<const double> means() const;
+    // Precond: count() > 0. Return NaN if the precondition is not met.
+    NODIS double mean(size_t i) const;
+    // Precond: count() > 1 with VarianceNorm::sample, count() > 0 with VarianceNorm::population. Return NaN if the
+    // precondition is not met.
+    NODIS double var(size_t i, VarianceNorm norm = VarianceNorm::sample) const;
+    NODIS double stddev(size_t i, VarianceNorm norm = VarianceNorm::sample) const;
+
+private:
+    double a;
+    size_t num_ticks = 0;
+    std::vector<double> running_means, population_vars;
+    double sum_sq_weights = 0;
+};
@@ -6,6 +6,10 @@
 #include "meadow/inplace_vector.h"
 
 #include <bit>
+#include <complex>
+#include <deque>
+#include <limits>
+#include <set>
 
 #if MEADOW_HAS_EIGEN == 1
   #include <mdspan> // For polyfit.
@@ -159,8 +163,35 @@ double hann_poisson_fn(int n, int L, double alpha);
 double kaiser_fn(int n, int L, double beta);
 #endif
 
+// Symmetric windows of length L, like the MATLAB functions of the same name.
 std::vector<double> blackman(int L);
 std::vector<double> gausswin(int L, double alpha);
+std::vector<double> hann(int L);
+std::vector<double> hamming(int L);
+std::vector<double> flattopwin(int L);
+// `r` is the ratio of the tapered section to the whole window: r <= 0 is `rectwin`, r >= 1 is `hann`.
+std::vector<double> tukeywin(int L, double r);
+// Unlike `kaiser_fn`, doesn't need `cyl_bessel_i`: I0 is evaluated with its power series, truncated once for the whole
+// window at the number of terms needed for I0(beta), relative error is a few ulps.
+std::vector<double> kaiser(int L, double beta);
+
+enum class WindowType {
+    rectwin,
+    blackman,
+    gausswin, // param: alpha
+    hann,
+    hamming,
+    flattopwin,
+    tukeywin, // param: r
+    kaiser    // param: beta
+};
+
+// Return the window of the given type, length and parameter (ignored for windows without a parameter) from a
+// process-wide cache, computing it on first use. Thread-safe. The returned span is valid until the end of the program.
+// Entries are never evicted, the cache grows with each distinct (type, L, param): it is meant for the few windows a
+// program uses over and over, compute windows with varying lengths or parameters directly.
+// Precond: param is finite.
+std::span<const double> cached_window(WindowType type, int L, double param = 0.0);
 
 template<class T>
 constexpr T nextpow2(T x)
@@ -191,9 +222,79 @@ void operator/=(vector<double>& xs, const double y);
 template<class T>
 std::array<T, 2> polyfit1(std::span<const T> xs, std::span<const T> ys);
 
+// Fits a line to the last `window` samples pushed, giving the same [slope, intercept] as `polyfit1` on them. Each
+// push updates the sums of x, x^2, y and xy in O(1) by adding the entering and subtracting the leaving sample. The
+// sums are recomputed from the window after every `window` pushes, which bounds the accumulated rounding error at
+// amortized O(1) cost. The x values are summed relative to the oldest x at the last recomputation, so large offsets
+// (e.g. timestamps) don't cancel.
+template<class T>
+class SlidingPolyfit1
+{
+public:
+    // Precond: window >= 2.
+    explicit SlidingPolyfit1(size_t window);
+
+    // Adds a sample, dropping the oldest one if the window is full.
+    void push(T x, T y);
+    // Returns [slope, intercept] of the samples in the window.
+    // Precond: size() >= 2, not all x equal.
+    NODIS std::array<T, 2> fit() const;
+    // Removes all samples.
+    void reset();
+
+    // Number of samples in the window, at most `window`.
+    NODIS size_t size() const;
+    NODIS bool full() const;
+
+private:
+    void resum();
+
+    std::vector<T> xs, ys; // Ring buffer, the next sample goes to `head`.
+    size_t head = 0, count = 0, pushes_since_resum = 0;
+    T origin = 0;
+    T sx = 0, sx2 = 0, sy = 0, sxy = 0; // Sums over the window, of x - origin.
+};
+
+// Fits a line to each run of `window` consecutive samples: element k of the result is
+// polyfit1(xs[k .. k + window), ys[k .. k + window)), for k in [0, size(xs) - window].
+// Precond: size(xs) == size(ys), window >= 2.
+template<class T>
+std::vector<std::array<T, 2>> sliding_polyfit1(std::span<const T> xs, std::span<const T> ys, size_t window);
+
 template<class C, class X>
 decltype(std::declval<C>() * std::declval<X>()) polyval(std::span<const C> cs, X x);
 
+namespace detail
+{
+// Horner's scheme, run on groups of x values side by side so that the independent evaluations are vectorized.
+template<class C, class X>
+void polyval_horner(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+);
+// Estrin's scheme at the top, Horner's below: p(x) = (P0(x^4) + x * P1(x^4)) + x^2 * (P2(x^4) + x * P3(x^4)), where
+// Pr has every fourth coefficient. The four Horner chains are independent and a quarter as long.
+template<class C, class X>
+void polyval_estrin(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+);
+} // namespace detail
+
+// Degree from which the batch `polyval` uses `detail::polyval_estrin`.
+inline constexpr size_t k_polyval_estrin_min_degree = 8;
+
+// Evaluates the polynomial `cs` (descending powers) at each of `xs` into `out`, like MATLAB's `polyval(p, x)` for a
+// vector `x`. Precond: size(out) == size(xs).
+template<class C, class X>
+void polyval(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+);
+
 template<class T>
 std::vector<T> polyder(std::span<const T> cs);
 
@@ -220,12 +321,64 @@ std::inplace_vector<T, N> polyder_noalloc(std::span<const T> cs)
 template<class T>
 std::inplace_vector<T, 2> real_roots2(std::span<const T, 3> cs);
 
+// Batch versions of `real_roots2` and its cubic and quartic counterparts. `cs` holds the coefficients (descending
+// powers) of consecutive polynomials of degree 2, 3 or 4. The real roots of each are written to its slots of `roots`
+// (2, 3 or 4 per polynomial) in ascending order, followed by NaNs. Unlike the scalar `real_roots2`, multiple roots are
+// repeated. Each polynomial is solved in closed form (Cardano / Viete for cubics, Ferrari for quartics), and cubic and
+// quartic roots are refined by a Newton step. The loops are scalar: the cubic and quartic formulas call acos, cos and
+// cbrt, which don't vectorize.
+// Precond: the leading coefficients are not zero, size(cs) / (degree + 1) == size(roots) / degree.
+template<class T>
+void real_roots2(std::span<const T> cs, std::span<T> roots);
+template<class T>
+void real_roots3(std::span<const T> cs, std::span<T> roots);
+template<class T>
+void real_roots4(std::span<const T> cs, std::span<T> roots);
+
 #if MEADOW_HAS_EIGEN == 1
 std::vector<double> polyfit(
   std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> xs,
   std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> ys,
   int degree
 );
+
+// Least-squares polynomial fits of the same degree to many series sampled at the same `xs`. The Vandermonde matrix is
+// factored once at construction (column-pivoting Householder QR, like `polyfit`) into its pseudo-inverse, after that
+// fitting a batch of series is a single matrix product.
+class PolyFitter
+{
+public:
+    // Precond: `xs` has at least degree + 1 distinct values.
+    PolyFitter(std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> xs, int degree);
+
+    // Fits each column (series) of `ys` and writes its coefficients in descending powers to the same row of `cs`, in
+    // parallel on `n_threads` threads (0 means std::thread::hardware_concurrency()). Rows of `ys` are the samples at
+    // `xs`, like in MATLAB.
+    // Precond: ys.extent(0) == size(), cs.extent(0) == ys.extent(1), cs.extent(1) == degree() + 1.
+    void fit(
+      std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> ys,
+      std::mdspan<double, std::dextents<size_t, 2>, std::layout_stride> cs,
+      size_t n_threads = 0
+    ) const;
+    // Returns the coefficients as a row-major ys.extent(1) x (degree() + 1) matrix.
+    NODIS std::vector<double>
+    fit(std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> ys, size_t n_threads = 0) const;
+    // Same as `polyfit(xs, ys, degree)`.
+    NODIS std::vector<double> fit(std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> ys) const;
+
+    NODIS int degree() const;
+    // Number of samples in a series, size(xs).
+    NODIS size_t size() const;
+
+private:
+    size_t n_coeffs, n_samples;
+    // (degree + 1) x size(xs), column-major, the rows ordered by descending powers.
+    std::vector<double> pinv;
+};
+
+// Roots of the polynomial with the coefficients `cs` in descending powers, like MATLAB's `roots(p)`: the eigenvalues
+// of the balanced companion matrix. Leading zeros of `cs` are ignored, trailing zeros give roots at 0 (listed last).
+std::vector<std::complex<double>> roots(std::span<const double> cs);
 #endif
 
 std::vector<double> linspace(double x1, double x2, size_t n);
@@ -252,6 +405,20 @@ double corr(span<const double> xs, span<const double> ys);
 // Precond: xs and ys have the same size, at least 2 elements with w = 0, at least 1 with w = 1.
 std::array<std::array<double, 2>, 2> cov(span<const double> xs, span<const double> ys, int w = 0);
 
+// Statistics of two series, computed together by `describe`.
+struct BivariateStats {
+    double mean_x, mean_y;
+    double var_x, var_y;
+    double cov;
+    double corr;
+};
+
+// Return the means, variances, covariance and correlation of xs and ys, like `mean`, `var`, `cov` and `corr` but in a
+// single pass over the data.
+// w = 0 means sample variance (normalize by N - 1), w = 1 is population variance (N)
+// Precond: xs and ys have the same size, at least 2 elements with w = 0, at least 1 with w = 1.
+BivariateStats describe(span<const double> xs, span<const double> ys, int w = 0);
+
 // Return standard deviation
 // w = 0 means sample variance (normalize by N - 1), w = 1 is population variance (N)
 // Precond: xs has at least 2 elements with w = 0, at least 1 with w = 1.
@@ -262,4 +429,128 @@ double std(span<const double> xs, int w = 0);
 // Precond: xs has at least 2 elements with w = 0, at least 1 with w = 1.
 double var(span<const double> xs, int w = 0);
 
+// Statistics of the last `window` samples pushed. The sum is updated in O(1) by adding the entering and subtracting the
+// leaving sample, and recomputed from the window after every `window` updates, which bounds the accumulated rounding
+// error at amortized O(1) cost. The squares are summed relative to the oldest sample at the last recomputation, so a
+// large offset doesn't cancel in the variance. The minimum and maximum are kept in amortized O(1) by monotonic deques.
+// Samples must be finite.
+class MovingStat
+{
+public:
+    // Precond: window >= 1.
+    explicit MovingStat(size_t window);
+
+    // Adds a sample, dropping the oldest one if the window is full.
+    void push(double x);
+    // Drops the oldest sample.
+    // Precond: size() > 0.
+    void pop();
+    // Removes all samples.
+    void reset();
+
+    // Number of samples in the window, at most `window`.
+    NODIS size_t size() const;
+    NODIS bool full() const;
+
+    NODIS double sum() const;
+    // Precond: size() > 0. Return NaN if the precondition is not met.
+    NODIS double mean() const;
+    NODIS double min() const;
+    NODIS double max() const;
+    // w = 0 means sample variance (normalize by N - 1), w = 1 is population variance (N). Like MATLAB, the variance of
+    // a single sample is 0.
+    // Precond: size() > 0. Return NaN if the precondition is not met.
+    NODIS double var(int w = 0) const;
+    NODIS double std(int w = 0) const;
+
+private:
+    struct Extremum {
+        uint64_t index; // Position in the stream of pushed samples.
+        double value;
+    };
+
+    void update_sums(double entering, double leaving);
+    void resum();
+
+    std::vector<double> xs; // Ring buffer, the next sample goes to `head`.
+    size_t head = 0, count = 0, updates_since_resum = 0;
+    uint64_t num_pushed = 0;
+    double origin = 0;
+    double s = 0, s2 = 0; // Sums over the window, of x - origin.
+    // Candidates for the minimum and maximum, front to back: increasing index, and increasing (for the minimum) or
+    // decreasing (for the maximum) value. The front is the extremum of the window.
+    std::deque<Extremum> mins, maxs;
+};
+
+// Median of the last `window` samples pushed, in O(log(window)) per push. The window is split into a lower and an
+// upper half, kept as two ordered multisets, the max-heap and min-heap of the two-heap method that also support
+// removing the leaving sample. Samples must be finite.
+class MovingMedian
+{
+public:
+    // Precond: window >= 1.
+    explicit MovingMedian(size_t window);
+
+    // Adds a sample, dropping the oldest one if the window is full.
+    void push(double x);
+    // Drops the oldest sample.
+    // Precond: size() > 0.
+    void pop();
+    // Removes all samples.
+    void reset();
+
+    // Number of samples in the window, at most `window`.
+    NODIS size_t size() const;
+    NODIS bool full() const;
+
+    // The middle sample, or the mean of the two middle ones for an even size().
+    // Precond: size() > 0. Return NaN if the precondition is not met.
+    NODIS double median() const;
+
+private:
+    void rebalance();
+
+    std::vector<double> xs; // Ring buffer, the next sample goes to `head`.
+    size_t head = 0, count = 0;
+    // lower.size() is upper.size() or upper.size() + 1, and every element of lower is <= every element of upper.
+    std::multiset<double> lower, upper;
+};
+
+// Window of the `mov*` functions: `before` samples before, and `after` samples after each sample.
+struct MovWindow {
+    size_t before, after;
+
+    // Window of length k, centered on each sample like MATLAB's `movmean(A, k)`: for even k, it has one sample more
+    // before than after. Implicit, so that the length can be passed for the window.
+    // Precond: k >= 1.
+    MovWindow(size_t k)
+        : before(k / 2)
+        , after((k - 1) / 2)
+    {
+        CHECK(k >= 1);
+    }
+    // Like MATLAB's `movmean(A, [kb kf])`.
+    // Precond: before_arg + after_arg <= PTRDIFF_MAX, so that neither the window length nor the index of its last
+    // sample overflows.
+    MovWindow(size_t before_arg, size_t after_arg)
+        : before(before_arg)
+        , after(after_arg)
+    {
+        constexpr size_t max_length = sucast(std::numeric_limits<ptrdiff_t>::max());
+        CHECK(after_arg <= max_length && before_arg <= max_length - after_arg);
+    }
+};
+
+// Moving-window statistics, like the MATLAB functions of the same name with the default 'Endpoints' 'shrink': element
+// i of the result is the statistic of xs[i - before .. i + after], truncated to the valid indices of xs. O(1) amortized
+// per element (O(log(window)) for `movmedian`), using `MovingStat` and `MovingMedian`.
+std::vector<double> movsum(span<const double> xs, MovWindow window);
+std::vector<double> movmean(span<const double> xs, MovWindow window);
+std::vector<double> movmin(span<const double> xs, MovWindow window);
+std::vector<double> movmax(span<const double> xs, MovWindow window);
+std::vector<double> movmedian(span<const double> xs, MovWindow window);
+// w = 0 means sample variance (normalize by N - 1), w = 1 is population variance (N).
+std::vector<double> movvar(span<const double> xs, MovWindow window, int w = 0);
+std::vector<double> movstd(span<const double> xs, MovWindow window, int w = 0);
+
 } // namespace matlab
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace matlab
+{
+
+// Precomputed tables for the complex discrete Fourier transform of a given size.
+// Power-of-two sizes use radix-4 (and one radix-2) butterflies, other sizes use Bluestein's algorithm on a
+// power-of-two plan. Plans are immutable, can be shared between threads.
+class FftPlan
+{
+public:
+    // Prefer `get`, which returns a cached plan.
+    explicit FftPlan(size_t n);
+
+    // Return the cached plan of size `n`, creating it on first use. Thread-safe.
+    static std::shared_ptr<const FftPlan> get(size_t n);
+
+    NODIS size_t size() const;
+
+    // In-place forward transform: X[k] = sum(x[j] * exp(-2*pi*i*j*k/n)). Precond: x.size() == size().
+    void forward(std::span<std::complex<double>> x) const;
+    // In-place inverse transform, including the 1/n scaling, like MATLAB's `ifft`. Precond: x.size() == size().
+    void inverse(std::span<std::complex<double>> x) const;
+
+private:
+    void forward_pow2(std::span<std::complex<double>> x) const;
+    void forward_bluestein(std::span<std::complex<double>> x) const;
+
+    size_t n;
+    // Power-of-two sizes.
+    std::vector<size_t> bit_reversed;
+    std::vector<std::complex<double>> twiddles; // exp(-2*pi*i*k/n), k = 0..n/2-1
+    // Bluestein's algorithm.
+    std::vector<std::complex<double>> chirp;    // exp(-pi*i*k^2/n), k = 0..n-1
+    std::vector<std::complex<double>> chirp_ft; // Forward transform of the conjugate chirp, wrapped to size m.
+    std::shared_ptr<const FftPlan> pow2_plan;   // Of size m >= 2n - 1.
+};
+
+// Discrete Fourier transform of real input, computing only the non-redundant n/2 + 1 bins.
+// Even sizes run a complex transform of half size. Plans are immutable, can be shared between threads.
+class RealFftPlan
+{
+public:
+    // Prefer `get`, which returns a cached plan.
+    explicit RealFftPlan(size_t n);
+
+    // Return the cached plan of size `n`, creating it on first use. Thread-safe.
+    static std::shared_ptr<const RealFftPlan> get(size_t n);
+
+    NODIS size_t size() const;
+
+    // X[k] = sum(x[j] * exp(-2*pi*i*j*k/n)) for k = 0..n/2. Precond: x.size() == size(), X.size() == size() / 2 + 1.
+    void forward(std::span<const double> x, std::span<std::complex<double>> X) const;
+    // Inverse of `forward`, including the 1/n scaling. Assumes the conjugate-symmetric continuation of X, the imaginary
+    // parts of X[0] and (for even sizes) X[n/2] are ignored. Precond: x.size() == size(), X.size() == size() / 2 + 1.
+    void inverse(std::span<const std::complex<double>> X, std::span<double> x) const;
+
+private:
+    size_t n;
+    std::shared_ptr<const FftPlan> plan;        // Of size n / 2 for even sizes, n for odd sizes.
+    std::vector<std::complex<double>> twiddles; // exp(-2*pi*i*k/n), k = 0..n/4, for even sizes.
+};
+
+// Discrete Fourier transform, like MATLAB's `fft(x)`.
+std::vector<std::complex<double>> fft(std::span<const std::complex<double>> x);
+std::vector<std::complex<double>> fft(std::span<const double> x);
+
+// Discrete Fourier transform of `x` padded with zeros or truncated to `n` samples, like MATLAB's `fft(x, n)`.
+std::vector<std::complex<double>> fft(std::span<const std::complex<double>> x, size_t n);
+std::vector<std::complex<double>> fft(std::span<const double> x, size_t n);
+
+// Inverse discrete Fourier transform, like MATLAB's `ifft(X)`.
+std::vector<std::complex<double>> ifft(std::span<const std::complex<double>> X);
+
+// The first n/2 + 1 bins of the discrete Fourier transform of real `x`, the rest are their complex conjugates.
+std::vector<std::complex<double>> rfft(std::span<const double> x);
+
+// Inverse of `rfft` for a real signal of `n` samples, like MATLAB's `ifft(X, 'symmetric')`.
+// Precond: X.size() == n / 2 + 1.
+std::vector<double> irfft(std::span<const std::complex<double>> X, size_t n);
+
+} // namespace matlab
@@ -1,7 +1,20 @@
 #pragma once
 
+#include "meadow/cppext.h"
+
+#include "meadow/constexpr_math.h"
+#include "meadow/inplace_vector.h"
+#include "meadow/matlab_fft.h"
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <complex>
+#include <concepts>
+#include <functional>
+#include <limits>
+#include <mdspan>
 #include <optional>
 #include <span>
 #include <variant>
@@ -44,22 +57,859 @@ struct TransferFunctionCoeffs {
     }
 };
 
+// Zeros, poles and gain of a transfer function: H(z) = k * prod(z - z_i) / prod(z - p_i).
+// Complex zeros and poles come in conjugate pairs.
+struct ZeroPoleGain {
+    std::vector<std::complex<double>> z, p;
+    double k;
+};
+
+// Cascade of second-order sections (biquads), like MATLAB's `[sos, g]` output.
+// Each section is [b0, b1, b2, a0, a1, a2] with a0 = 1, the overall transfer function is
+// H(z) = g * prod(H_i(z)).
+struct SecondOrderSections {
+    std::vector<std::array<double, 6>> sos;
+    double g;
+};
+
 // Returns direct-form IIR coefficients [b, a] of a digital Butterworth filter.
-// Frequencies are normalized: 0 < Wn < 1, where 1 = Nyquist frequency.
+// Frequencies are normalized: 0 < Wn < 1, where 1 = Nyquist frequency, with low < high for BP and BS (checked).
 // LP and HP produce a filter of the given order.
 // BP and BS apply the LP-to-BP/BS transformation, producing a filter of order 2*order.
 TransferFunctionCoeffs butter(int order, const FilterType::V& filter);
 
+// Same as `butter` but returns the digital zeros, poles and gain, like MATLAB's `[z, p, k] = butter(...)`.
+ZeroPoleGain butter_zpk(int order, const FilterType::V& filter);
+
+// Same as `butter` but returns second-order sections. Prefer this for high orders and narrow bands where the
+// direct-form coefficients lose precision.
+SecondOrderSections butter_sos(int order, const FilterType::V& filter);
+
+// Like `TransferFunctionCoeffs`, with at most N coefficients each, stored in place.
+template<size_t N>
+struct InplaceTransferFunctionCoeffs {
+    std::inplace_vector<double, N> b, a;
+};
+
+namespace detail
+{
+// Real coefficients of the polynomial with the given roots in descending powers, `work` is scratch space.
+// Precond: size(c) == size(roots) + 1, size(work) >= size(roots) + 1.
+void poly_core(std::span<const std::complex<double>> roots, std::span<std::complex<double>> work, std::span<double> c);
+
+// Math functions usable in constant expressions, evaluated with the more accurate <cmath> and <complex> functions at
+// run time.
+constexpr double ce_tan(double x)
+{
+    if consteval {
+        return cx::tan(x);
+    } else {
+        return std::tan(x);
+    }
+}
+
+constexpr double ce_sqrt(double x)
+{
+    if consteval {
+        return cx::sqrt(x);
+    } else {
+        return std::sqrt(x);
+    }
+}
+
+constexpr cx::complex ce_sqrt(cx::complex z)
+{
+    if consteval {
+        return cx::sqrt(z);
+    } else {
+        const auto r = std::sqrt(std::complex<double>(z.re, z.im));
+        return {r.real(), r.imag()};
+    }
+}
+
+constexpr double ce_abs(cx::complex z)
+{
+    if consteval {
+        return cx::abs(z);
+    } else {
+        return std::hypot(z.re, z.im);
+    }
+}
+
+// exp(i * angle)
+constexpr cx::complex ce_unit_polar(double angle)
+{
+    if consteval {
+        return cx::unit_polar(angle);
+    } else {
+        return {std::cos(angle), std::sin(angle)};
+    }
+}
+
+// Order of the digital filter `butter(order, filter)`.
+constexpr int butter_digital_order(int order, const FilterType::V& filter)
+{
+    const bool doubled =
+      std::holds_alternative<FilterType::BandPass>(filter) || std::holds_alternative<FilterType::BandStop>(filter);
+    return doubled ? 2 * order : order;
+}
+
+// Checks that the cutoffs are normalized, 0 < Wn < 1, and in order for BP and BS. In a constant expression a failed
+// check is a compile error.
+constexpr void check_cutoffs(const FilterType::V& filter)
+{
+    std::visit(
+      [](const auto& f) {
+          using T = std::decay_t<decltype(f)>;
+          if constexpr (std::is_same_v<T, FilterType::LowPass> || std::is_same_v<T, FilterType::HighPass>) {
+              CHECK(0 < f.cutoff && f.cutoff < 1);
+          } else {
+              CHECK(0 < f.low_cutoff && f.low_cutoff < f.high_cutoff && f.high_cutoff < 1);
+          }
+      },
+      filter
+    );
+}
+
+// Bilinear transform: s-domain -> z-domain (T = 1), z = (2 + s) / (2 - s).
+constexpr cx::complex bilinear_s(cx::complex s)
+{
+    return (2.0 + s) / (2.0 - s);
+}
+
+// The gain k that normalizes |H(z_ref)| to 1.
+constexpr double gain_at(std::span<const cx::complex> z, std::span<const cx::complex> p, cx::complex z_ref)
+{
+    cx::complex num = 1.0, den = 1.0;
+    for (auto zi : z) {
+        num = num * (z_ref - zi);
+    }
+    for (auto pk : p) {
+        den = den * (z_ref - pk);
+    }
+    return ce_abs(den / num);
+}
+
+// Writes the zeros and poles of `butter(order, filter)` to `z` and `p`, returns the gain. Shared by the run-time and
+// the compile-time `butter`.
+// Precond: size(z) == size(p) == butter_digital_order(order, filter).
+constexpr double butter_zpk_core(
+  int order,
+  const FilterType::V& filter,
+  std::span<cx::complex> z,
+  std::span<cx::complex> p
+)
+{
+    CHECK(order >= 1);
+    CHECK(z.size() == p.size() && cmp_equal(p.size(), butter_digital_order(order, filter)));
+    check_cutoffs(filter);
+    const auto N = sucast(order);
+    // Analog Butterworth prototype pole k = 1..N, on the unit circle in the left half-plane:
+    // p_k = exp(j * pi * (2k + N - 1) / (2N))
+    const auto proto_pole = [N](size_t k) {
+        return ce_unit_polar(std::numbers::pi * ifcast<double>(2 * k + N - 1) / ifcast<double>(2 * N));
+    };
+    const auto prewarp = [](double Wn) {
+        return 2.0 * ce_tan(std::numbers::pi * Wn / 2.0);
+    };
+    return std::visit(
+      [&](const auto& f) -> double {
+          using T = std::decay_t<decltype(f)>;
+          if constexpr (std::is_same_v<T, FilterType::LowPass>) {
+              const double wc = prewarp(f.cutoff);
+              for (size_t k = 0; k < N; ++k) {
+                  p[k] = bilinear_s(proto_pole(k + 1) * wc);
+                  z[k] = -1.0;
+              }
+              return gain_at(z, p, 1.0); // normalize DC gain to 1
+          } else if constexpr (std::is_same_v<T, FilterType::HighPass>) {
+              const double wc = prewarp(f.cutoff);
+              for (size_t k = 0; k < N; ++k) {
+                  p[k] = bilinear_s(wc / proto_pole(k + 1)); // LP->HP: s -> wc/s
+                  z[k] = 1.0;
+              }
+              return gain_at(z, p, -1.0); // normalize Nyquist gain to 1
+          } else {
+              const double w1 = prewarp(f.low_cutoff);
+              const double w2 = prewarp(f.high_cutoff);
+              const double w0 = ce_sqrt(w1 * w2);
+              const double Bw = w2 - w1;
+              constexpr bool band_pass = std::is_same_v<T, FilterType::BandPass>;
+              for (size_t k = 0; k < N; ++k) {
+                  const auto s = proto_pole(k + 1);
+                  // LP->BP: each s_k solves s^2 - s_k*Bw*s + w0^2 = 0 -> two poles
+                  // LP->BS: each s_k solves s_k*s^2 - Bw*s + s_k*w0^2 = 0
+                  //         s = Bw/(2*s_k) +- sqrt((Bw/(2*s_k))^2 - w0^2)
+                  const auto q = band_pass ? s * (Bw / 2.0) : Bw / (2.0 * s);
+                  const auto sq = ce_sqrt(q * q - w0 * w0);
+                  p[2 * k] = bilinear_s(q + sq);
+                  p[2 * k + 1] = bilinear_s(q - sq);
+              }
+              const auto z_center = bilinear_s({0.0, w0});
+              if constexpr (band_pass) {
+                  // N zeros at z=+1 (w=0) and N zeros at z=-1 (w=pi)
+                  for (size_t k = 0; k < N; ++k) {
+                      z[k] = 1.0;
+                      z[N + k] = -1.0;
+                  }
+                  // Normalize at the bilinear-transformed analog center frequency
+                  return gain_at(z, p, z_center);
+              } else {
+                  // Transmission zeros at +-j*w0 in analog -> conjugate pair on unit circle in z
+                  for (size_t k = 0; k < N; ++k) {
+                      z[2 * k] = z_center;
+                      z[2 * k + 1] = cx::conj(z_center);
+                  }
+                  return gain_at(z, p, 1.0); // normalize DC gain to 1
+              }
+          }
+      },
+      filter
+    );
+}
+// Writes the coefficients of `bilinear(b, a, fs, fp)` to `bz` and `az`.
+// Precond: size(bz) == size(az) == max(size(b), size(a)), size(work) >= size(bz).
+void bilinear_core(
+  std::span<const double> b,
+  std::span<const double> a,
+  double fs,
+  std::optional<double> fp,
+  std::span<double> bz,
+  std::span<double> az,
+  std::span<double> work
+);
+} // namespace detail
+
+// Allocation-free versions of `poly`, `butter` and `bilinear`, for designing filters where the heap must not be used
+// (e.g. on an audio thread). `MaxOrder` is the maximum order of the resulting polynomials/filters.
+
+// The real polynomial with the given roots, like MATLAB's `poly(r)`, in descending powers.
+// Precond: complex roots come in conjugate pairs, size(roots) <= MaxOrder.
+template<size_t MaxOrder>
+std::inplace_vector<double, MaxOrder + 1> poly_noalloc(std::span<const std::complex<double>> roots)
+{
+    CHECK(roots.size() <= MaxOrder);
+    std::array<std::complex<double>, MaxOrder + 1> work;
+    std::inplace_vector<double, MaxOrder + 1> c;
+    c.resize(roots.size() + 1);
+    detail::poly_core(roots, work, std::span<double>(c.begin(), c.end()));
+    return c;
+}
+
+// Precond: the order of the digital filter (2 * order for BP and BS) is at most MaxOrder.
+template<size_t MaxOrder>
+InplaceTransferFunctionCoeffs<MaxOrder + 1> butter_noalloc(int order, const FilterType::V& filter)
+{
+    const auto n = sucast(detail::butter_digital_order(order, filter));
+    CHECK(n <= MaxOrder);
+    std::array<cx::complex, MaxOrder> zc, pc;
+    const double k = detail::butter_zpk_core(order, filter, std::span(zc).first(n), std::span(pc).first(n));
+    std::array<std::complex<double>, MaxOrder> z, p;
+    for (size_t i = 0; i < n; ++i) {
+        z[i] = {zc[i].re, zc[i].im};
+        p[i] = {pc[i].re, pc[i].im};
+    }
+    std::array<std::complex<double>, MaxOrder + 1> work;
+    InplaceTransferFunctionCoeffs<MaxOrder + 1> tf;
+    tf.b.resize(n + 1);
+    tf.a.resize(n + 1);
+    detail::poly_core(std::span(z).first(n), work, std::span<double>(tf.b.begin(), tf.b.end()));
+    detail::poly_core(std::span(p).first(n), work, std::span<double>(tf.a.begin(), tf.a.end()));
+    for (auto& c : tf.b) {
+        c *= k;
+    }
+    return tf;
+}
+
+// Direct-form coefficients in fixed-size arrays, see `butter<Order>`.
+template<size_t N>
+struct StaticTransferFunctionCoeffs {
+    std::array<double, N> b, a; // a[0] = 1.
+};
+
+namespace detail
+{
+template<size_t N>
+constexpr std::array<double, N + 1> poly_constexpr(const std::array<cx::complex, N>& roots)
+{
+    std::array<cx::complex, N + 1> c{};
+    c[0] = 1.0;
+    for (size_t i = 0; i < N; ++i) {
+        c[i + 1] = -(c[i] * roots[i]);
+        for (size_t j = i; j >= 1; --j) {
+            c[j] = c[j] - c[j - 1] * roots[i];
+        }
+    }
+    std::array<double, N + 1> r{};
+    for (size_t i = 0; i <= N; ++i) {
+        r[i] = c[i].re;
+    }
+    return r;
+}
+} // namespace detail
+
+// Compile-time version of `butter` for a fixed order, the same design with `constexpr` arithmetic, e.g.
+//     static constexpr auto tf = matlab::butter<4>(matlab::FilterType::LowPass{0.1});
+// The result has Order + 1 coefficients for LP and HP and 2 * Order + 1 for BP and BS, use it with `StaticIirFilter`.
+// Both share `detail::butter_zpk_core`, cutoffs out of range (see `detail::check_cutoffs`) don't compile.
+template<size_t Order, class Filter>
+    requires(Order >= 1)
+constexpr auto butter(const Filter& filter)
+{
+    constexpr bool is_band =
+      std::is_same_v<Filter, FilterType::BandPass> || std::is_same_v<Filter, FilterType::BandStop>;
+    static_assert(
+      is_band || std::is_same_v<Filter, FilterType::LowPass> || std::is_same_v<Filter, FilterType::HighPass>
+    );
+    constexpr size_t N = is_band ? 2 * Order : Order;
+
+    // Out-of-range cutoffs fail here at compile time.
+    std::array<cx::complex, N> z, p;
+    const double k = detail::butter_zpk_core(iicast<int>(Order), filter, z, p);
+    StaticTransferFunctionCoeffs<N + 1> tf{detail::poly_constexpr(z), detail::poly_constexpr(p)};
+    for (auto& c : tf.b) {
+        c *= k;
+    }
+    return tf;
+}
+
+// Runs a transfer function of N coefficients (e.g. from `butter<Order>`) like `IirFilter`. The size is a
+// compile-time constant, so the loops over the coefficients are fully unrolled.
+template<size_t N, std::floating_point T = double>
+    requires(N >= 1)
+class StaticIirFilter
+{
+public:
+    using sample_type = T;
+
+    // Precond: tf.a[0] != 0.
+    constexpr explicit StaticIirFilter(const StaticTransferFunctionCoeffs<N>& tf)
+    {
+        for (size_t i = 0; i < N; ++i) {
+            b[i] = static_cast<T>(tf.b[i] / tf.a[0]);
+            a[i] = static_cast<T>(tf.a[i] / tf.a[0]);
+        }
+    }
+
+    // Filters a single sample.
+    constexpr T operator()(T x)
+    {
+        const T y = b[0] * x + (N > 1 ? z[0] : T(0));
+        if constexpr (N > 1) {
+            for (size_t k = 1; k + 1 < N; ++k) {
+                z[k - 1] = b[k] * x + z[k] - a[k] * y;
+            }
+            z[N - 2] = b[N - 1] * x - a[N - 1] * y;
+        }
+        return y;
+    }
+    // Filters `x` into `y`. `x` and `y` must have the same size, they may refer to the same buffer.
+    constexpr void process(std::span<const T> x, std::span<T> y)
+    {
+        assert(x.size() == y.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            y[i] = (*this)(x[i]);
+        }
+    }
+    // Sets the state to zero, as if the filter had only seen zeros.
+    constexpr void reset()
+    {
+        z = {};
+    }
+
+private:
+    std::array<T, N> b{}, a{};
+    std::array<T, N - 1> z{};
+};
+
+// Direct-form coefficients from zeros, poles and gain, like MATLAB's `[b, a] = zp2tf(z, p, k)`. The shorter of `b`
+// and `a` is padded with leading zeros.
+TransferFunctionCoeffs zp2tf(const ZeroPoleGain& zpk);
+
+#if MEADOW_HAS_EIGEN == 1
+// Zeros, poles and gain of the transfer function b / a, like MATLAB's `[z, p, k] = tf2zp(b, a)`. The coefficients are
+// in descending powers, leading zeros are ignored. The roots are found with `roots`.
+ZeroPoleGain tf2zp(std::span<const double> b, std::span<const double> a);
+#endif
+
+// Convert zero-pole-gain form to second-order sections, like MATLAB's `[sos, g] = zp2sos(z, p, k)`.
+// Poles closest to the unit circle are paired with the nearest zeros and placed in the last sections.
+// Precond: complex zeros and poles come in conjugate pairs.
+SecondOrderSections zp2sos(const ZeroPoleGain& zpk);
+
+// Runs a cascade of second-order sections (transposed direct form II) on consecutive blocks of samples,
+// keeping the state between the calls. Does not allocate after construction.
+// The sections are designed in double and run in `T`, SosFilter<float> is the robust choice for float samples.
+template<std::floating_point T = double>
+class SosFilter
+{
+public:
+    using sample_type = T;
+
+    explicit SosFilter(const SecondOrderSections& sos);
+
+    // Filters `x` into `y`. `x` and `y` must have the same size, they may refer to the same buffer.
+    void process(std::span<const T> x, std::span<T> y);
+    // Filters a single sample.
+    T operator()(T x);
+    // Sets the state to zero, as if the filter had only seen zeros.
+    void reset();
+
+private:
+    struct Section {
+        T b0, b1, b2, a1, a2; // Normalized to a0 = 1.
+        T s1, s2;             // State.
+    };
+    std::vector<Section> sections;
+    T g;
+};
+
 // Return the frequency response of the specified digital filter at the normalized frequency `w`.
 // NOTE: following MATLAB conventions, `w` is in rad/s (positive frequencies: 0..pi),
 // unlike other functions (e.g. `butter`) where the frequency is
 // normalized to Nyquist (positive frequencies: 0..1)
 std::complex<double> freqz(std::span<const double> b, std::span<const double> a, double w);
 
+// Frequency response at the frequencies `w`, see `FrequencyResponse`.
+struct FrequencyResponse {
+    std::vector<std::complex<double>> h;
+    std::vector<double> w;
+
+    NODIS std::vector<double> magnitude() const; // abs(h)
+    NODIS std::vector<double> phase() const;     // angle(h), in -pi..pi
+};
+
+// Batch version of `freqz`: writes the frequency response at each of `w` to `h`, evaluating several frequencies at
+// once. `w` and `h` must have the same size. Does not allocate.
+void freqz(
+  std::span<const double> b,
+  std::span<const double> a,
+  std::span<const double> w,
+  std::span<std::complex<double>> h
+);
+
+// Frequency response at `w`, like MATLAB's `[h, w] = freqz(b, a, w)`.
+FrequencyResponse freqz(std::span<const double> b, std::span<const double> a, std::span<const double> w);
+
+// Frequency response at `n` evenly spaced frequencies w = (0:n-1) * pi / n, like MATLAB's `[h, w] = freqz(b, a, n)`.
+// Computed with FFTs of size 2n.
+FrequencyResponse freqz(std::span<const double> b, std::span<const double> a, size_t n);
+
+// Output of `filter`: the filtered signal and the final state of the filter.
+struct FilterResult {
+    std::vector<double> y, zf;
+};
+
+// Filter `x` with the rational transfer function `b / a`, like MATLAB's `[y, zf] = filter(b, a, x, zi)`.
+// `zi` is the initial state, its size must be max(size(a), size(b)) - 1, or empty for zero initial state.
+// Precond: a[0] != 0.
+FilterResult filter(
+  std::span<const double> b,
+  std::span<const double> a,
+  std::span<const double> x,
+  std::span<const double> zi = {}
+);
+
+// Runs the rational transfer function `b / a` (transposed direct form II) on consecutive blocks of samples, keeping
+// the state between the calls. Does not allocate after construction.
+// The coefficients are normalized in double and then rounded to the sample type `T`. Direct-form coefficients are
+// sensitive to rounding, for float samples and high orders prefer `SosFilter<float>`.
+template<std::floating_point T = double>
+class IirFilter
+{
+public:
+    using sample_type = T;
+
+    // Precond: a[0] != 0.
+    IirFilter(std::span<const double> b, std::span<const double> a);
+    explicit IirFilter(const TransferFunctionCoeffs& tf);
+
+    // Filters `x` into `y`. `x` and `y` must have the same size, they may refer to the same buffer.
+    void process(std::span<const T> x, std::span<T> y);
+    // Filters a single sample.
+    T operator()(T x);
+    // Sets the state to zero, as if the filter had only seen zeros.
+    void reset();
+
+    // The state has `order()` elements, compatible with the `zi` and `zf` of `filter`.
+    NODIS size_t order() const;
+    NODIS std::span<const T> state() const;
+    void set_state(std::span<const T> zi);
+
+    // The coefficients, normalized to a[0] = 1 and padded to the same size, `order() + 1`.
+    NODIS std::span<const T> numerator() const;
+    NODIS std::span<const T> denominator() const;
+
+private:
+    std::vector<T> b, a; // Padded to the same size, normalized to a[0] = 1.
+    std::vector<T> z;
+};
+
+// Runs the same rational transfer function `b / a` on many channels, keeping the state between the calls, like one
+// `IirFilter` per channel. The channels are processed `k_lanes` at a time: the state is stored in structure-of-arrays
+// form, so the recurrence of a group of channels is a sequence of lane-wise operations the compiler vectorizes.
+// Does not allocate after construction.
+template<std::floating_point T = double>
+class IirFilterBank
+{
+public:
+    using sample_type = T;
+    // Channels processed together, two AVX2 or one AVX-512 register: 8 doubles or 16 floats.
+    static constexpr size_t k_lanes = 64 / sizeof(T);
+
+    // Precond: a[0] != 0.
+    IirFilterBank(std::span<const double> b, std::span<const double> a, size_t n_channels);
+    IirFilterBank(const TransferFunctionCoeffs& tf, size_t n_channels);
+
+    // Filters each column (channel) of `xs` into the same column of `ys`. Rows are samples, like in MATLAB. Row-major
+    // strides (n_channels, 1) describe interleaved samples, column-major strides (1, n_samples) planar ones.
+    // Precond: `xs` and `ys` have the same extents, n_channels() columns. They may refer to the same buffer.
+    void process(
+      std::mdspan<const T, std::dextents<size_t, 2>, std::layout_stride> xs,
+      std::mdspan<T, std::dextents<size_t, 2>, std::layout_stride> ys
+    );
+    // Sets the state to zero, as if the filters had only seen zeros.
+    void reset();
+
+    NODIS size_t n_channels() const;
+    NODIS size_t order() const;
+
+private:
+    std::vector<T> b, a; // Padded to the same size, normalized to a[0] = 1.
+    size_t channels;
+    // State of channel c at delay k: z[((c / k_lanes) * order() + k) * k_lanes + c % k_lanes]. The channels are padded
+    // to a multiple of k_lanes, the padding lanes filter zeros.
+    std::vector<T> z;
+};
+
+// Zero-phase filtering: filter `x` with `b / a` forward and then backward, like MATLAB's `filtfilt(b, a, x)`.
+// The ends of `x` are extended by odd reflection of 3 * (max(size(a), size(b)) - 1) samples and the filter starts
+// from the steady-state of a step input scaled to the first sample, to minimize the start-up transients.
+// Precond: size(x) > 3 * (max(size(a), size(b)) - 1), a[0] != 0.
+std::vector<double> filtfilt(std::span<const double> b, std::span<const double> a, std::span<const double> x);
+
+// Batch version of `filtfilt`: filters each column (channel) of `xs` into the same column of `ys`, in parallel on
+// `n_threads` threads (0 means std::thread::hardware_concurrency()). Rows are samples, like in MATLAB.
+// Precond: `xs` and `ys` have the same extents and do not overlap.
+void filtfilt(
+  std::span<const double> b,
+  std::span<const double> a,
+  std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> xs,
+  std::mdspan<double, std::dextents<size_t, 2>, std::layout_stride> ys,
+  size_t n_threads = 0
+);
+
 // Convert the analog filter `H(s) = b / a` to a discrete time system using the bilinear "Tustin" approximation with
 // sample rate `fs` and optional frequency prewarping ('fp').
 // Corresponds to one of the signatures of MATLAB's `bilinear` function.
+// With Eigen, the transform is done on the roots (`tf2zp`, `bilinear_zpk`, `zp2tf`), which is more accurate for high
+// orders than expanding the polynomials.
 TransferFunctionCoeffs
 bilinear(std::span<const double> b, std::span<const double> a, double fs, std::optional<double> fp);
 
+// Bilinear transform of the analog filter given by its zeros, poles and gain, like MATLAB's
+// `[zd, pd, kd] = bilinear(z, p, k, fs, fp)`: maps each root with z = (λ + s) / (λ - s), where λ = 2 * fs, or
+// 2 * pi * fp / tan(pi * fp / fs) with prewarping. The missing zeros (or poles) are placed at z = -1.
+ZeroPoleGain bilinear_zpk(const ZeroPoleGain& analog, double fs, std::optional<double> fp);
+
+// Allocation-free version of `bilinear`, see `butter_noalloc`.
+// Precond: max(size(b), size(a)) <= MaxOrder + 1.
+template<size_t MaxOrder>
+InplaceTransferFunctionCoeffs<MaxOrder + 1>
+bilinear_noalloc(std::span<const double> b, std::span<const double> a, double fs, std::optional<double> fp)
+{
+    const size_t n_coeffs = std::max(b.size(), a.size());
+    CHECK(n_coeffs <= MaxOrder + 1);
+    std::array<double, MaxOrder + 1> work;
+    InplaceTransferFunctionCoeffs<MaxOrder + 1> tf;
+    tf.b.resize(n_coeffs);
+    tf.a.resize(n_coeffs);
+    detail::bilinear_core(
+      b,
+      a,
+      fs,
+      fp,
+      std::span<double>(tf.b.begin(), tf.b.end()),
+      std::span<double>(tf.a.begin(), tf.a.end()),
+      work
+    );
+    return tf;
+}
+
+// Window-based FIR filter design, like MATLAB's `b = fir1(n, Wn, ftype, window)`: returns the n + 1 coefficients of
+// the ideal response truncated by `window` and scaled to unit gain at the center of the first passband.
+// Frequencies are normalized: 0 < Wn < 1, where 1 = Nyquist frequency. An empty `window` means `hamming(n + 1)`.
+// Precond: size(window) is 0 or n + 1, `n` is even for high-pass and band-stop filters.
+std::vector<double> fir1(int n, const FilterType::V& filter, std::span<const double> window = {});
+
+// Output of `kaiserord`: pass `kaiser(n + 1, beta)` as the window of `fir1(n, filter)`.
+struct KaiserOrder {
+    int n;
+    FilterType::V filter;
+    double beta;
+};
+
+// Estimate the order, cutoffs and Kaiser window parameter of an FIR filter meeting the specification, like MATLAB's
+// `[n, Wn, beta, ftype] = kaiserord(f, a, dev, fs)`. `f` are the band edges in the units of `fs`, `a` the desired
+// amplitudes (0 or 1) of the size(f) / 2 + 1 bands and `dev` their maximum deviations. Supports the four `FilterType`s:
+// a = {1, 0}, {0, 1}, {0, 1, 0} and {1, 0, 1}.
+KaiserOrder kaiserord(std::span<const double> f, std::span<const double> a, std::span<const double> dev, double fs = 2);
+
+// Least-squares linear-phase FIR filter design, like MATLAB's `b = firls(n, f, a)`: returns the n + 1 coefficients
+// minimizing the integrated squared error from the desired amplitude, which is linear from a[i] at f[i] to a[i + 1] at
+// f[i + 1] in the bands (f[0], f[1]), (f[2], f[3]), ... Frequencies are normalized: 0 <= f <= 1, where 1 = Nyquist
+// frequency. The error is unweighted and the transition bands between the bands are don't-care regions.
+// Precond: size(f) == size(a) is even, `f` is non-decreasing.
+#if MEADOW_HAS_EIGEN == 1
+std::vector<double> firls(int n, std::span<const double> f, std::span<const double> a);
+#endif
+
+// Runs an FIR filter on consecutive blocks of samples, keeping the state between the calls. Gives the same output as
+// `filter(b, 1, x)` split into blocks. Short filters use direct-form convolution, long ones FFT overlap-save
+// convolution. The cost of the FFT depends on the block size: a call to `process` runs one FFT of about 4 * size(b)
+// points per block of about 3 * size(b) samples, or per call if it is shorter, which is O(log(size(b))) per sample
+// only for calls with a full block. Direct form is O(size(b)) per sample regardless. Does not allocate after
+// construction.
+class FirFilter
+{
+public:
+    using sample_type = double;
+
+    enum class Method {
+        automatic, // `fft` from `k_min_fft_taps` taps, except for calls too short for the FFT to pay off.
+        direct,
+        fft
+    };
+    static constexpr size_t k_min_fft_taps = 64;
+
+    // Precond: `b` is not empty.
+    explicit FirFilter(std::span<const double> b, Method method = Method::automatic);
+
+    // Filters `x` into `y`. `x` and `y` must have the same size, they may refer to the same buffer.
+    void process(std::span<const double> x, std::span<double> y);
+    // Filters a single sample, always in direct form.
+    double operator()(double x);
+    // Sets the state to zero, as if the filter had only seen zeros.
+    void reset();
+
+    NODIS bool uses_fft() const;
+
+private:
+    void process_block(std::span<const double> x, std::span<double> y);
+
+    std::vector<double> b_reversed;
+    // The last size(b) - 1 inputs, followed by room for the current block.
+    std::vector<double> line;
+    size_t block_size;
+    // FFT overlap-save, for blocks of at least `min_fft_block` samples.
+    std::shared_ptr<const RealFftPlan> plan;
+    size_t min_fft_block = 0;
+    std::vector<std::complex<double>> b_ft; // Transform of `b` padded to the FFT size.
+    std::vector<double> segment;
+    std::vector<std::complex<double>> spectrum;
+};
+
+// Fixed-point samples: an `I` value v stands for v / 2^(bits - 1), in [-1, 1), e.g. Q15 for int16_t.
+template<std::signed_integral I, std::floating_point T>
+void fixed_to_float(std::span<const I> x, std::span<T> y)
+{
+    assert(x.size() == y.size());
+    constexpr T scale = 1 / (static_cast<T>(std::numeric_limits<I>::max()) + 1);
+    for (size_t i = 0; i < x.size(); ++i) {
+        y[i] = static_cast<T>(x[i]) * scale;
+    }
+}
+
+// Inverse of `fixed_to_float`, rounds to nearest and saturates at the limits of `I`.
+template<std::floating_point T, std::signed_integral I>
+void float_to_fixed(std::span<const T> x, std::span<I> y)
+{
+    assert(x.size() == y.size());
+    // Computed in double, which holds the limits of int32_t exactly.
+    constexpr double scale = static_cast<double>(std::numeric_limits<I>::max()) + 1;
+    constexpr double lo = std::numeric_limits<I>::min(), hi = std::numeric_limits<I>::max();
+    for (size_t i = 0; i < x.size(); ++i) {
+        y[i] = static_cast<I>(std::clamp(std::nearbyint(static_cast<double>(x[i]) * scale), lo, hi));
+    }
+}
+
+// Runs `filter` (e.g. IirFilter<float>, SosFilter<float>) on fixed-point samples, converting them in blocks on the
+// stack. `x` and `y` must have the same size, they may refer to the same buffer.
+template<std::signed_integral I, class Filter>
+void process_fixed(Filter& filter, std::span<const I> x, std::span<I> y)
+{
+    using T = typename Filter::sample_type;
+    assert(x.size() == y.size());
+    std::array<T, 256> buffer;
+    for (size_t i = 0; i < x.size(); i += buffer.size()) {
+        const auto block = std::span(buffer).first(std::min(buffer.size(), x.size() - i));
+        fixed_to_float(x.subspan(i, block.size()), block);
+        filter.process(block, block);
+        float_to_fixed(std::span<const T>(block), y.subspan(i, block.size()));
+    }
+}
+
+// Upsample `x` by `p` (inserting p - 1 zeros after each sample), filter it with the FIR filter `h` and downsample it
+// by `q` (keeping every q-th sample), like MATLAB's `upfirdn(x, h, p, q)`. The output has
+// ceil(((size(x) - 1) * p + size(h)) / q) samples. Computed with the polyphase decomposition of `h`, only the kept
+// output samples are computed and the inserted zeros are never multiplied.
+// Precond: `h` is not empty, p >= 1, q >= 1.
+std::vector<double> upfirdn(std::span<const double> x, std::span<const double> h, int p = 1, int q = 1);
+
+// Change the sample rate of `x` by the factor p / q, like MATLAB's `resample(x, p, q)`: applies `upfirdn` with a
+// Kaiser-windowed (beta = 5) ideal low-pass filter of 2 * 10 * max(p, q) + 1 taps, and compensates its delay.
+// The output has ceil(size(x) * p / q) samples. The filters are cached per p / q.
+// Precond: p >= 1, q >= 1.
+std::vector<double> resample(std::span<const double> x, int p, int q);
+
+// Runs `upfirdn` on consecutive blocks of samples, keeping the state between the calls. The concatenated outputs are
+// the same as the output of `upfirdn` on the concatenated inputs, without the tail. Does not allocate after
+// construction.
+class StreamingUpfirdn
+{
+public:
+    // Precond: `h` is not empty, p >= 1, q >= 1.
+    StreamingUpfirdn(std::span<const double> h, int p, int q);
+
+    // Upper bound of the number of output samples for `n` input samples.
+    NODIS size_t max_output_size(size_t n) const;
+    // Filters `x` into the beginning of `y` and returns the number of output samples.
+    // Precond: size(y) >= max_output_size(size(x)), `x` and `y` don't overlap.
+    size_t process(std::span<const double> x, std::span<double> y);
+    // Sets the state to zero, as if the filter had only seen zeros.
+    void reset();
+
+private:
+    size_t p, q;
+    size_t n_phase_taps; // ceil(size(h) / p)
+    std::vector<double> phases; // Phase r at [r * n_phase_taps, (r + 1) * n_phase_taps), reversed.
+    std::vector<double> line;   // The last n_phase_taps - 1 inputs, followed by room for a block.
+    size_t t = 0;               // Upsampled time of the next output, relative to the next input.
+    static constexpr size_t k_block_size = 1024;
+};
+
+namespace detail
+{
+struct ResampleFilter; // A cached filter of `resample`.
+} // namespace detail
+
+// Runs `resample` on consecutive blocks of samples, keeping the state between the calls. The concatenated outputs are
+// the same as the output of `resample` on the concatenated inputs, without the tail of the filter's delay.
+// Does not allocate after construction.
+class StreamingResampler
+{
+public:
+    // Precond: p >= 1, q >= 1.
+    StreamingResampler(int p, int q);
+
+    // Upper bound of the number of output samples for `n` input samples.
+    NODIS size_t max_output_size(size_t n) const;
+    // Resamples `x` into the beginning of `y` and returns the number of output samples.
+    // Precond: size(y) >= max_output_size(size(x)), `x` and `y` don't overlap.
+    size_t process(std::span<const double> x, std::span<double> y);
+    // Restarts the stream, as if it had seen no samples.
+    void reset();
+
+private:
+    explicit StreamingResampler(const detail::ResampleFilter& filter);
+
+    StreamingUpfirdn polyphase;
+    size_t delay;
+    size_t to_skip; // Outputs of `upfirdn` still to drop to compensate the delay.
+};
+
+// Power spectral density estimate, see `pwelch`.
+struct PowerSpectralDensity {
+    std::vector<double> pxx; // Power per radian per sample, one-sided.
+    std::vector<double> w;   // Normalized frequencies, rad/sample: (0:nfft/2) * 2 * pi / nfft.
+};
+
+// Welch's power spectral density estimate of the real signal `x`, like MATLAB's `pwelch(x, window, noverlap, nfft)`:
+// the average of the periodograms of the segments of `x`, each of size(window) samples, overlapping by `noverlap`
+// samples and multiplied by `window` (e.g. from `blackman` or `gausswin`). Returns the one-sided estimate.
+// The segments are distributed among `n_threads` threads (0 means std::thread::hardware_concurrency()), their
+// periodograms are added in the same order on every run with the same `n_threads`.
+// Precond: noverlap < size(window) <= nfft, size(x) >= size(window).
+PowerSpectralDensity pwelch(
+  std::span<const double> x,
+  std::span<const double> window,
+  size_t noverlap,
+  size_t nfft,
+  size_t n_threads = 0
+);
+
+// Short-time Fourier transform, see `spectrogram`.
+struct Spectrogram {
+    std::vector<std::complex<double>> s; // Column-major, n_freqs x n_segments.
+    size_t n_freqs, n_segments;
+    std::vector<double> w; // Normalized frequencies of the rows, rad/sample: (0:nfft/2) * 2 * pi / nfft.
+    std::vector<double> t; // Centers of the segments, in samples (0-based).
+
+    NODIS std::span<const std::complex<double>> column(size_t j) const;
+};
+
+// Short-time Fourier transform of the real signal `x`, like MATLAB's `spectrogram(x, window, noverlap, nfft)`: the
+// one-sided DFTs (nfft / 2 + 1 bins) of the segments of `x` as in `pwelch`.
+// The segments are distributed among `n_threads` threads (0 means std::thread::hardware_concurrency()).
+// Precond: noverlap < size(window) <= nfft, size(x) >= size(window).
+Spectrogram spectrogram(
+  std::span<const double> x,
+  std::span<const double> window,
+  size_t noverlap,
+  size_t nfft,
+  size_t n_threads = 0
+);
+
+// Streaming short-time Fourier transform: accepts the signal in blocks of any size and produces the same columns as
+// `spectrogram`, keeping only the last size(window) - 1 samples. Does not allocate after construction.
+class StreamingStft
+{
+public:
+    // Precond: noverlap < size(window) <= nfft.
+    StreamingStft(std::span<const double> window, size_t noverlap, size_t nfft);
+
+    // Appends `x` to the signal and calls `on_column` for each segment completed by it, in order. The column
+    // (n_freqs() bins) is valid only during the call.
+    void push(
+      std::span<const double> x,
+      const std::function<void(std::span<const std::complex<double>> column)>& on_column
+    );
+    // Discards the buffered samples, the next sample starts a new segment.
+    void reset();
+
+    NODIS size_t n_freqs() const;
+
+private:
+    std::vector<double> window;
+    size_t hop;
+    std::shared_ptr<const RealFftPlan> plan;
+    std::vector<double> pending; // The samples of the current segment received so far.
+    size_t n_pending = 0;
+    std::vector<double> segment; // The windowed, zero-padded segment.
+    std::vector<std::complex<double>> spectrum;
+};
+
+// Streaming version of `pwelch`: accepts the signal in blocks of any size and accumulates the periodograms of the
+// completed segments.
+class StreamingWelch
+{
+public:
+    // Precond: noverlap < size(window) <= nfft.
+    StreamingWelch(std::span<const double> window, size_t noverlap, size_t nfft);
+
+    void push(std::span<const double> x);
+
+    // Number of segments averaged so far.
+    NODIS size_t n_segments() const;
+    // The estimate from the segments completed so far. Precond: n_segments() > 0.
+    NODIS PowerSpectralDensity psd() const;
+
+private:
+    StreamingStft stft;
+    std::vector<double> window;
+    size_t nfft;
+    std::vector<double> sum_periodograms;
+    size_t num_segments = 0;
+};
+
 } // namespace matlab
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Split [0, n) into at most `n_threads` consecutive, disjoint chunks and call `fn(begin, end)` for each of them, each
+// chunk on a separate thread (the first one on the calling thread). Returns when all the chunks are done.
+// `n_threads` = 0 means std::thread::hardware_concurrency(). `fn` must not throw.
+void parallel_for_chunks(size_t n, size_t n_threads, const std::function<void(size_t begin, size_t end)>& fn);
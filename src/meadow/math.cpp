@@ -1,11 +1,160 @@
 #include "meadow/math.h"
 
 #include "meadow/matlab.h"
+#include "meadow/parallel.h"
+
+#include <array>
+#include <thread>
 
 #if MEADOW_HAS_EIGEN == 1
   #include "meadow/eigen_dense.h"
 #endif
 
+namespace detail
+{
+namespace
+{
+constexpr size_t k_deviation_sums_lanes = 8;
+
+// Adds the independent lanes to the sum of the elements after the last full group of lanes.
+double addLanes(double tail, const std::array<double, k_deviation_sums_lanes>& lanes)
+{
+    for (auto x : lanes) {
+        tail += x;
+    }
+    return tail;
+}
+
+// Deviation sums of a block in two passes, each summing all its terms in independent lanes: the means, minimum and
+// maximum, then the sums of the deviations from the means, their squares and products, with the correction term that
+// cancels the rounding error of the means. The returned means are relative to `kx` and `ky`, corrected by the same
+// term.
+template<bool with_y>
+DeviationSums blockDeviationSums(const double* x, const double* y, size_t n, double kx, double ky)
+{
+    constexpr size_t L = k_deviation_sums_lanes;
+    const double nd = ifcast<double>(n);
+    const size_t n_full = n - n % L;
+
+    std::array<double, L> lx{}, ly{}, lo, hi;
+    lo.fill(INFINITY);
+    hi.fill(-INFINITY);
+    for (size_t i = 0; i < n_full; i += L) {
+        for (size_t l = 0; l < L; ++l) {
+            lx[l] += x[i + l];
+            lo[l] = x[i + l] < lo[l] ? x[i + l] : lo[l];
+            hi[l] = x[i + l] > hi[l] ? x[i + l] : hi[l];
+            if constexpr (with_y) {
+                ly[l] += y[i + l];
+            }
+        }
+    }
+    double tx = 0, ty = 0;
+    for (size_t i = n_full; i < n; ++i) {
+        tx += x[i];
+        lo[0] = std::min(lo[0], x[i]);
+        hi[0] = std::max(hi[0], x[i]);
+        if constexpr (with_y) {
+            ty += y[i];
+        }
+    }
+    const double mean_x = addLanes(tx, lx) / nd;
+    const double mean_y = with_y ? addLanes(ty, ly) / nd : 0.0;
+
+    std::array<double, L> ldx{}, ldx2{}, ldy{}, ldy2{}, ldxdy{};
+    for (size_t i = 0; i < n_full; i += L) {
+        for (size_t l = 0; l < L; ++l) {
+            const double dx = x[i + l] - mean_x;
+            ldx[l] += dx;
+            ldx2[l] += dx * dx;
+            if constexpr (with_y) {
+                const double dy = y[i + l] - mean_y;
+                ldy[l] += dy;
+                ldy2[l] += dy * dy;
+                ldxdy[l] += dx * dy;
+            }
+        }
+    }
+    double tdx = 0, tdx2 = 0, tdy = 0, tdy2 = 0, tdxdy = 0;
+    for (size_t i = n_full; i < n; ++i) {
+        const double dx = x[i] - mean_x;
+        tdx += dx;
+        tdx2 += dx * dx;
+        if constexpr (with_y) {
+            const double dy = y[i] - mean_y;
+            tdy += dy;
+            tdy2 += dy * dy;
+            tdxdy += dx * dy;
+        }
+    }
+
+    DeviationSums r;
+    r.n = nd;
+    r.min_x = *ra::min_element(lo);
+    r.max_x = *ra::max_element(hi);
+    const double sum_dx = addLanes(tdx, ldx);
+    r.mean_x = (mean_x - kx) + sum_dx / nd;
+    r.sxx = addLanes(tdx2, ldx2) - square(sum_dx) / nd;
+    if constexpr (with_y) {
+        const double sum_dy = addLanes(tdy, ldy);
+        r.mean_y = (mean_y - ky) + sum_dy / nd;
+        r.syy = addLanes(tdy2, ldy2) - square(sum_dy) / nd;
+        r.sxy = addLanes(tdxdy, ldxdy) - sum_dx * sum_dy / nd;
+    }
+    return r;
+}
+
+template<bool with_y>
+DeviationSums deviationSums(std::span<const double> xs, std::span<const double> ys)
+{
+    DeviationSums r;
+    if (xs.empty()) {
+        return r;
+    }
+    const double kx = xs[0], ky = with_y ? ys[0] : 0.0;
+    for (size_t i = 0; i < xs.size(); i += k_deviation_sums_block) {
+        const size_t n = std::min(k_deviation_sums_block, xs.size() - i);
+        r = merge_deviation_sums(
+          r,
+          blockDeviationSums<with_y>(xs.data() + i, with_y ? ys.data() + i : nullptr, n, kx, ky)
+        );
+    }
+    r.mean_x += kx;
+    r.mean_y += ky;
+    return r;
+}
+} // namespace
+
+DeviationSums merge_deviation_sums(const DeviationSums& a, const DeviationSums& b)
+{
+    if (a.n == 0) {
+        return b;
+    }
+    if (b.n == 0) {
+        return a;
+    }
+    const double n = a.n + b.n;
+    const double dx = b.mean_x - a.mean_x, dy = b.mean_y - a.mean_y;
+    const double f = a.n * b.n / n;
+    return DeviationSums{
+      .n = n,
+      .mean_x = a.mean_x + dx * b.n / n,
+      .mean_y = a.mean_y + dy * b.n / n,
+      .sxx = a.sxx + b.sxx + square(dx) * f,
+      .sxy = a.sxy + b.sxy + dx * dy * f,
+      .syy = a.syy + b.syy + square(dy) * f,
+      .min_x = std::min(a.min_x, b.min_x),
+      .max_x = std::max(a.max_x, b.max_x)
+    };
+}
+
+DeviationSums deviation_sums(std::span<const double> xs, std::span<const double> ys)
+{
+    CHECK(ys.empty() || ys.size() == xs.size());
+    return ys.empty() ? deviationSums<false>(xs, ys) : deviationSums<true>(xs, ys);
+}
+} // namespace detail
+
 void RunningStat::operator()(double sample)
 {
     assert(std::isfinite(sample));
@@ -18,6 +167,39 @@ void RunningStat::operator()(double sample)
     max_sample = std::max(max_sample, sample);
 }
 
+void RunningStat::add(std::span<const double> samples)
+{
+    assign(
+      num_samples + samples.size(),
+      detail::merge_deviation_sums(deviation_sums(), detail::deviation_sums(samples))
+    );
+}
+
+void RunningStat::merge(const RunningStat& other)
+{
+    assign(num_samples + other.num_samples, detail::merge_deviation_sums(deviation_sums(), other.deviation_sums()));
+}
+
+detail::DeviationSums RunningStat::deviation_sums() const
+{
+    detail::DeviationSums r;
+    r.n = ifcast<double>(num_samples);
+    r.mean_x = running_mean;
+    r.sxx = sum_sq_dev;
+    r.min_x = min_sample;
+    r.max_x = max_sample;
+    return r;
+}
+
+void RunningStat::assign(size_t count, const detail::DeviationSums& sums)
+{
+    num_samples = count;
+    running_mean = sums.mean_x;
+    sum_sq_dev = sums.sxx;
+    min_sample = sums.min_x;
+    max_sample = sums.max_x;
+}
+
 void RunningStat::reset()
 {
     *this = RunningStat();
@@ -67,6 +249,622 @@ double RunningStat::stddev(VarianceNorm norm) const
     return sqrt(var(norm));
 }
 
+void RunningMoments::operator()(double sample)
+{
+    assert(std::isfinite(sample));
+
+    const auto n1 = ifcast<double>(num_samples);
+    ++num_samples;
+    const auto n = ifcast<double>(num_samples);
+    const double delta = sample - running_mean;
+    const double delta_n = delta / n;
+    const double delta_n2 = delta_n * delta_n;
+    const double term1 = delta * delta_n * n1;
+    running_mean += delta_n;
+    m4 += term1 * delta_n2 * (n * n - 3 * n + 3) + 6 * delta_n2 * m2 - 4 * delta_n * m3;
+    m3 += term1 * delta_n * (n - 2) - 3 * delta_n * m2;
+    m2 += term1;
+}
+
+void RunningMoments::merge(const RunningMoments& other)
+{
+    if (other.num_samples == 0) {
+        return;
+    }
+    if (num_samples == 0) {
+        *this = other;
+        return;
+    }
+    const auto na = ifcast<double>(num_samples), nb = ifcast<double>(other.num_samples);
+    const double n = na + nb;
+    const double delta = other.running_mean - running_mean;
+    const double delta2 = delta * delta;
+    num_samples += other.num_samples;
+    running_mean += delta * nb / n;
+    m4 += other.m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+        + 6 * delta2 * (na * na * other.m2 + nb * nb * m2) / (n * n) + 4 * delta * (na * other.m3 - nb * m3) / n;
+    m3 += other.m3 + delta2 * delta * na * nb * (na - nb) / (n * n) + 3 * delta * (na * other.m2 - nb * m2) / n;
+    m2 += other.m2 + delta2 * na * nb / n;
+}
+
+void RunningMoments::reset()
+{
+    *this = RunningMoments();
+}
+
+size_t RunningMoments::count() const
+{
+    return num_samples;
+}
+
+double RunningMoments::mean() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : running_mean;
+}
+
+double RunningMoments::var(VarianceNorm norm) const
+{
+    const size_t min_samples = norm == VarianceNorm::sample ? 2 : 1;
+    assert(num_samples >= min_samples);
+    if (num_samples < min_samples) {
+        return NAN;
+    }
+    const auto n = ifcast<double>(num_samples);
+    return m2 / (norm == VarianceNorm::sample ? n - 1 : n);
+}
+
+double RunningMoments::stddev(VarianceNorm norm) const
+{
+    return sqrt(var(norm));
+}
+
+double RunningMoments::skewness() const
+{
+    assert(num_samples > 0);
+    if (num_samples == 0 || m2 == 0) {
+        return NAN;
+    }
+    return sqrt(ifcast<double>(num_samples)) * m3 / (m2 * sqrt(m2));
+}
+
+double RunningMoments::excess_kurtosis() const
+{
+    assert(num_samples > 0);
+    if (num_samples == 0 || m2 == 0) {
+        return NAN;
+    }
+    return ifcast<double>(num_samples) * m4 / (m2 * m2) - 3;
+}
+
+RunningStat parallel_running_stat(std::span<const double> samples, size_t n_threads)
+{
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // One part per thread, merged in order, so that the result doesn't depend on the scheduling.
+    const size_t n_parts = std::max<size_t>(1, std::min(n_threads, samples.size() / detail::k_deviation_sums_block));
+    std::vector<RunningStat> parts(n_parts);
+    parallel_for_chunks(n_parts, n_threads, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const size_t first = samples.size() * k / n_parts, last = samples.size() * (k + 1) / n_parts;
+            parts[k].add(samples.subspan(first, last - first));
+        }
+    });
+    RunningStat r;
+    for (auto& part : parts) {
+        r.merge(part);
+    }
+    return r;
+}
+
+namespace
+{
+// Quantile `p` of the sorted `xs`, MATLAB's definition: the i-th smallest of n samples is the (i - 0.5) / n quantile,
+// linear interpolation in between, the minimum and maximum beyond.
+double sorted_quantile(std::span<const double> xs, double p)
+{
+    const double index = std::clamp(p * ifcast<double>(xs.size()) - 0.5, 0.0, ifcast<double>(xs.size() - 1));
+    const auto i = std::min(static_cast<size_t>(index), xs.size() - 1);
+    if (i + 1 == xs.size()) {
+        return xs[i];
+    }
+    return xs[i] + (index - ifcast<double>(i)) * (xs[i + 1] - xs[i]);
+}
+} // namespace
+
+P2Quantiles::P2Quantiles(std::span<const double> ps_arg)
+    : ps(ps_arg.begin(), ps_arg.end())
+{
+    CHECK(!ps.empty());
+    fractions.push_back(0);
+    for (size_t i = 0; i < ps.size(); ++i) {
+        CHECK(0 <= ps[i] && ps[i] <= 1 && (i == 0 || ps[i - 1] < ps[i]));
+        fractions.push_back(((i == 0 ? 0 : ps[i - 1]) + ps[i]) / 2);
+        fractions.push_back(ps[i]);
+    }
+    fractions.push_back((ps.back() + 1) / 2);
+    fractions.push_back(1);
+    reset();
+}
+
+void P2Quantiles::operator()(double sample)
+{
+    assert(std::isfinite(sample));
+
+    const size_t m = fractions.size();
+    if (num_samples < m) {
+        // Keep the first samples sorted, they become the initial markers.
+        heights.insert(std::upper_bound(heights.begin(), heights.end(), sample), sample);
+        ++num_samples;
+        if (num_samples == m) {
+            for (size_t i = 0; i < m; ++i) {
+                positions.push_back(ifcast<double>(i));
+                desired.push_back(fractions[i] * ifcast<double>(m - 1));
+            }
+        }
+        return;
+    }
+    ++num_samples;
+
+    // Find the cell of the sample, extending the extreme markers, and move the markers above it.
+    size_t k = 0;
+    if (sample < heights[0]) {
+        heights[0] = sample;
+    } else if (sample >= heights[m - 1]) {
+        heights[m - 1] = sample;
+        k = m - 2;
+    } else {
+        k = iicast<size_t>(std::upper_bound(heights.begin(), heights.end(), sample) - heights.begin()) - 1;
+    }
+    for (size_t i = k + 1; i < m; ++i) {
+        positions[i] += 1;
+    }
+    for (size_t i = 0; i < m; ++i) {
+        desired[i] += fractions[i];
+    }
+
+    // Move the inner markers that are off their desired position by one or more, if there is room, adjusting their
+    // height with the piecewise-parabolic formula, or linearly when that would break the order of the heights.
+    for (size_t i = 1; i + 1 < m; ++i) {
+        const double d = desired[i] - positions[i];
+        if (!((d >= 1 && positions[i + 1] - positions[i] > 1) || (d <= -1 && positions[i - 1] - positions[i] < -1))) {
+            continue;
+        }
+        const double s = d > 0 ? 1 : -1;
+        const double q = heights[i], qm = heights[i - 1], qp = heights[i + 1];
+        const double n = positions[i], nm = positions[i - 1], np = positions[i + 1];
+        const double parabolic =
+            q + s / (np - nm) * ((n - nm + s) * (qp - q) / (np - n) + (np - n - s) * (q - qm) / (n - nm));
+        if (qm < parabolic && parabolic < qp) {
+            heights[i] = parabolic;
+        } else {
+            const size_t j = s > 0 ? i + 1 : i - 1;
+            heights[i] = q + s * (heights[j] - q) / (positions[j] - n);
+        }
+        positions[i] += s;
+    }
+}
+
+void P2Quantiles::add(std::span<const double> samples)
+{
+    for (double x : samples) {
+        (*this)(x);
+    }
+}
+
+void P2Quantiles::reset()
+{
+    heights.clear();
+    positions.clear();
+    desired.clear();
+    num_samples = 0;
+}
+
+size_t P2Quantiles::count() const
+{
+    return num_samples;
+}
+
+size_t P2Quantiles::num_quantiles() const
+{
+    return ps.size();
+}
+
+double P2Quantiles::quantile(size_t i) const
+{
+    CHECK(i < ps.size());
+    assert(num_samples > 0);
+    if (num_samples == 0) {
+        return NAN;
+    }
+    if (num_samples < fractions.size()) {
+        return sorted_quantile(heights, ps[i]);
+    }
+    return heights[2 * i + 2];
+}
+
+TDigest::TDigest(double compression_arg)
+    : compression(compression_arg)
+{
+    CHECK(compression >= 10);
+    buffer_capacity = 5 * static_cast<size_t>(compression);
+    buffer.reserve(buffer_capacity);
+}
+
+void TDigest::operator()(double sample)
+{
+    assert(std::isfinite(sample));
+    buffer.push_back({sample, 1});
+    ++num_samples;
+    min_sample = std::min(min_sample, sample);
+    max_sample = std::max(max_sample, sample);
+    if (buffer.size() >= buffer_capacity) {
+        compress();
+    }
+}
+
+void TDigest::add(std::span<const double> samples)
+{
+    while (!samples.empty()) {
+        const auto batch = samples.first(std::min(samples.size(), buffer_capacity - buffer.size()));
+        for (double x : batch) {
+            assert(std::isfinite(x));
+            buffer.push_back({x, 1});
+            min_sample = std::min(min_sample, x);
+            max_sample = std::max(max_sample, x);
+        }
+        num_samples += batch.size();
+        samples = samples.subspan(batch.size());
+        if (buffer.size() >= buffer_capacity) {
+            compress();
+        }
+    }
+}
+
+void TDigest::merge(const TDigest& other)
+{
+    buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+    buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+    num_samples += other.num_samples;
+    min_sample = std::min(min_sample, other.min_sample);
+    max_sample = std::max(max_sample, other.max_sample);
+    if (buffer.size() >= buffer_capacity) {
+        compress();
+    }
+}
+
+void TDigest::reset()
+{
+    centroids.clear();
+    buffer.clear();
+    num_samples = 0;
+    min_sample = INFINITY;
+    max_sample = -INFINITY;
+}
+
+size_t TDigest::count() const
+{
+    return num_samples;
+}
+
+double TDigest::min() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : min_sample;
+}
+
+double TDigest::max() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : max_sample;
+}
+
+double TDigest::quantile(double p) const
+{
+    assert(num_samples > 0);
+    if (num_samples == 0) {
+        return NAN;
+    }
+    compress();
+    // Interpolate linearly between the centroids, placed at the middle of their weight, and the minimum and maximum at
+    // the ends. With one sample per centroid this is MATLAB's definition.
+    const auto total = ifcast<double>(num_samples);
+    const double index = std::clamp(p, 0.0, 1.0) * total;
+    double prev_position = 0, prev_value = min_sample, weight_before = 0;
+    for (const auto& c : centroids) {
+        const double position = weight_before + c.weight / 2;
+        if (index < position) {
+            return prev_value + (index - prev_position) / (position - prev_position) * (c.mean - prev_value);
+        }
+        weight_before += c.weight;
+        prev_position = position;
+        prev_value = c.mean;
+    }
+    return prev_value + (index - prev_position) / (total - prev_position) * (max_sample - prev_value);
+}
+
+size_t TDigest::num_centroids() const
+{
+    compress();
+    return centroids.size();
+}
+
+void TDigest::compress() const
+{
+    if (buffer.empty()) {
+        return;
+    }
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::ranges::sort(buffer, {}, &Centroid::mean);
+
+    // Scale function k1: a centroid may span at most 1 in k(q) = compression / (2 pi) * asin(2q - 1), which keeps the
+    // centroids near q = 0 and q = 1 small.
+    const double k_scale = compression / (2 * num::pi);
+    const auto q_limit_after = [k_scale](double q) {
+        const double k = k_scale * std::asin(2 * q - 1) + 1;
+        return (std::sin(std::min(k / k_scale, num::pi / 2)) + 1) / 2;
+    };
+    const auto total = ifcast<double>(num_samples);
+    scratch.clear();
+    Centroid current = buffer[0];
+    double weight_before = 0;
+    double q_limit = q_limit_after(0);
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        const auto& next = buffer[i];
+        if ((weight_before + current.weight + next.weight) / total <= q_limit) {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        } else {
+            weight_before += current.weight;
+            scratch.push_back(current);
+            q_limit = q_limit_after(weight_before / total);
+            current = next;
+        }
+    }
+    scratch.push_back(current);
+    std::swap(centroids, scratch);
+    buffer.clear();
+}
+
+namespace
+{
+double ewmAlpha(double halflife)
+{
+    CHECK(halflife > 0);
+    return 1 - std::exp2(-1 / halflife);
+}
+
+// Sum of the squared weights after adding a sample to `n` samples.
+double ewmNextSumSqWeights(double sum_sq_weights, double alpha, size_t n)
+{
+    return n == 0 ? 1 : square(1 - alpha) * sum_sq_weights + square(alpha);
+}
+
+// The weights sum to 1, the sample (reliability weights) variance divides by 1 - sum(w^2) instead.
+double ewmVar(double population_var, double sum_sq_weights, size_t n, VarianceNorm norm)
+{
+    const size_t min_samples = norm == VarianceNorm::sample ? 2 : 1;
+    assert(n >= min_samples);
+    if (n < min_samples) {
+        return NAN;
+    }
+    return norm == VarianceNorm::sample ? population_var / (1 - sum_sq_weights) : population_var;
+}
+} // namespace
+
+EwmStat::EwmStat(double halflife)
+    : a(ewmAlpha(halflife))
+{
+}
+
+void EwmStat::operator()(double sample)
+{
+    assert(std::isfinite(sample));
+    sum_sq_weights = ewmNextSumSqWeights(sum_sq_weights, a, num_samples);
+    if (num_samples++ == 0) {
+        running_mean = sample;
+        return;
+    }
+    const double delta = sample - running_mean;
+    running_mean += a * delta;
+    population_var = (1 - a) * (population_var + a * square(delta));
+}
+
+void EwmStat::add(std::span<const double> samples)
+{
+    for (double x : samples) {
+        (*this)(x);
+    }
+}
+
+void EwmStat::reset()
+{
+    num_samples = 0;
+    running_mean = population_var = sum_sq_weights = 0;
+}
+
+size_t EwmStat::count() const
+{
+    return num_samples;
+}
+
+double EwmStat::alpha() const
+{
+    return a;
+}
+
+double EwmStat::mean() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : running_mean;
+}
+
+double EwmStat::var(VarianceNorm norm) const
+{
+    return ewmVar(population_var, sum_sq_weights, num_samples, norm);
+}
+
+double EwmStat::stddev(VarianceNorm norm) const
+{
+    return sqrt(var(norm));
+}
+
+EwmCov::EwmCov(double halflife)
+    : a(ewmAlpha(halflife))
+{
+}
+
+void EwmCov::operator()(double x, double y)
+{
+    assert(std::isfinite(x) && std::isfinite(y));
+    sum_sq_weights = ewmNextSumSqWeights(sum_sq_weights, a, num_samples);
+    if (num_samples++ == 0) {
+        running_mean_x = x;
+        running_mean_y = y;
+        return;
+    }
+    const double dx = x - running_mean_x, dy = y - running_mean_y;
+    running_mean_x += a * dx;
+    running_mean_y += a * dy;
+    population_var_x = (1 - a) * (population_var_x + a * dx * dx);
+    population_var_y = (1 - a) * (population_var_y + a * dy * dy);
+    population_cov = (1 - a) * (population_cov + a * dx * dy);
+}
+
+void EwmCov::add(std::span<const double> xs, std::span<const double> ys)
+{
+    CHECK(xs.size() == ys.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        (*this)(xs[i], ys[i]);
+    }
+}
+
+void EwmCov::reset()
+{
+    num_samples = 0;
+    running_mean_x = running_mean_y = 0;
+    population_var_x = population_var_y = population_cov = sum_sq_weights = 0;
+}
+
+size_t EwmCov::count() const
+{
+    return num_samples;
+}
+
+double EwmCov::mean_x() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : running_mean_x;
+}
+
+double EwmCov::mean_y() const
+{
+    assert(num_samples > 0);
+    return num_samples == 0 ? NAN : running_mean_y;
+}
+
+double EwmCov::var_x(VarianceNorm norm) const
+{
+    return ewmVar(population_var_x, sum_sq_weights, num_samples, norm);
+}
+
+double EwmCov::var_y(VarianceNorm norm) const
+{
+    return ewmVar(population_var_y, sum_sq_weights, num_samples, norm);
+}
+
+double EwmCov::cov(VarianceNorm norm) const
+{
+    return ewmVar(population_cov, sum_sq_weights, num_samples, norm);
+}
+
+double EwmCov::corr() const
+{
+    assert(num_samples > 0);
+    const double d = sqrt(population_var_x * population_var_y);
+    return num_samples == 0 || d == 0 ? NAN : population_cov / d;
+}
+
+MultiEwmStat::MultiEwmStat(size_t n_series, double halflife)
+    : a(ewmAlpha(halflife))
+    , running_means(n_series)
+    , population_vars(n_series)
+{
+}
+
+void MultiEwmStat::operator()(std::span<const double> samples)
+{
+    CHECK(samples.size() == running_means.size());
+    sum_sq_weights = ewmNextSumSqWeights(sum_sq_weights, a, num_ticks);
+    if (num_ticks++ == 0) {
+        ra::copy(samples, running_means.begin());
+        return;
+    }
+    const size_t n = samples.size();
+    const double* x = samples.data();
+    double* m = running_means.data();
+    double* v = population_vars.data();
+    const double alpha = a, beta = 1 - a;
+    for (size_t i = 0; i < n; ++i) {
+        assert(std::isfinite(x[i]));
+        const double delta = x[i] - m[i];
+        m[i] += alpha * delta;
+        v[i] = beta * (v[i] + alpha * delta * delta);
+    }
+}
+
+void MultiEwmStat::add(std::span<const double> ticks)
+{
+    const size_t n = running_means.size();
+    CHECK(n == 0 ? ticks.empty() : ticks.size() % n == 0);
+    for (size_t begin = 0; begin < ticks.size(); begin += n) {
+        (*this)(ticks.subspan(begin, n));
+    }
+}
+
+void MultiEwmStat::reset()
+{
+    num_ticks = 0;
+    sum_sq_weights = 0;
+    ra::fill(running_means, 0.0);
+    ra::fill(population_vars, 0.0);
+}
+
+size_t MultiEwmStat::size() const
+{
+    return running_means.size();
+}
+
+size_t MultiEwmStat::count() const
+{
+    return num_ticks;
+}
+
+std::span<const double> MultiEwmStat::means() const
+{
+    assert(num_ticks > 0);
+    return running_means;
+}
+
+double MultiEwmStat::mean(size_t i) const
+{
+    CHECK(i < running_means.size());
+    assert(num_ticks > 0);
+    return num_ticks == 0 ? NAN : running_means[i];
+}
+
+double MultiEwmStat::var(size_t i, VarianceNorm norm) const
+{
+    CHECK(i < running_means.size());
+    return ewmVar(population_vars[i], sum_sq_weights, num_ticks, norm);
+}
+
+double MultiEwmStat::stddev(size_t i, VarianceNorm norm) const
+{
+    return sqrt(var(i, norm));
+}
+
 std::pair<double, double> extremumOfParabola(double ym1, double y0, double yp1)
 {
     const double a = (ym1 + yp1) / 2 - y0;
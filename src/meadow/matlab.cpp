@@ -2,9 +2,14 @@
 
 #include "meadow/cppext.h"
 #include "meadow/math.h"
+#include "meadow/parallel.h"
 
 #include <complex>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <system_error>
+#include <tuple>
 
 #if MEADOW_HAS_CYL_BESSEL_I == 0 && MEADOW_HAS_BOOST == 1
   #include <boost/math/special_functions/bessel.hpp>
@@ -38,13 +43,87 @@ double rectwin_fn(int n, int L)
     return 0 <= n && n < L ? 1.0 : 0.0;
 }
 
-std::vector<double> blackman(int L)
+namespace
 {
+// Symmetric generalized cosine window: w[n] = sum(a[k] * cos(2*pi*k*n / (L-1))).
+// Computes the first half and mirrors it. Only cos(2*pi*n / (L-1)) is evaluated, the higher harmonics come from the
+// Chebyshev recurrence cos(k*t) = 2*cos(t)*cos((k-1)*t) - cos((k-2)*t) in a loop that vectorizes.
+vector<double> cosine_sum_window(int L, span<const double> a)
+{
+    CHECK(L >= 0 && a.size() >= 2);
     vector<double> w(sucast(L));
+    if (L == 1) {
+        w[0] = 1.0;
+        return w;
+    }
+    const auto N = sucast(L);
+    const size_t half = (N + 1) / 2;
     const double c0 = 2 * num::pi / (L - 1);
-    const double c1 = 4 * num::pi / (L - 1);
-    for (auto n : vi_iota<int>(0, L)) {
-        w[sucast(n)] = 0.42 - 0.5 * cos(c0 * n) + 0.08 * cos(c1 * n);
+    for (size_t n = 0; n < half; ++n) {
+        w[n] = cos(c0 * ifcast<double>(n));
+    }
+    for (size_t n = 0; n < half; ++n) {
+        const double c1 = w[n];
+        double c_km2 = 1.0, c_km1 = c1;
+        double sum = a[0] + a[1] * c1;
+        for (size_t k = 2; k < a.size(); ++k) {
+            const double c_k = 2 * c1 * c_km1 - c_km2;
+            sum += a[k] * c_k;
+            c_km2 = c_km1;
+            c_km1 = c_k;
+        }
+        w[n] = sum;
+    }
+    for (size_t n = half; n < N; ++n) {
+        w[n] = w[N - 1 - n];
+    }
+    return w;
+}
+} // namespace
+
+std::vector<double> blackman(int L)
+{
+    const double a[] = {0.42, -0.5, 0.08};
+    return cosine_sum_window(L, a);
+}
+
+std::vector<double> hann(int L)
+{
+    const double a[] = {0.5, -0.5};
+    return cosine_sum_window(L, a);
+}
+
+std::vector<double> hamming(int L)
+{
+    const double a[] = {0.54, -0.46};
+    return cosine_sum_window(L, a);
+}
+
+std::vector<double> flattopwin(int L)
+{
+    const double a[] = {0.21557895, -0.41663158, 0.277263158, -0.083578947, 0.006947368};
+    return cosine_sum_window(L, a);
+}
+
+std::vector<double> tukeywin(int L, double r)
+{
+    CHECK(L >= 0);
+    if (r <= 0) {
+        return vector<double>(sucast(L), 1.0);
+    }
+    if (r >= 1) {
+        return hann(L);
+    }
+    vector<double> w(sucast(L), 1.0);
+    if (L == 1) {
+        return w;
+    }
+    // Cosine tapers over the first and last r/2 fraction of t = linspace(0, 1, L).
+    const double per = r / 2;
+    const int tl = ifloor<int>(per * (L - 1)) + 1;
+    for (int n = 0; n < tl; ++n) {
+        const double t = ifcast<double>(n) / (L - 1);
+        w[sucast(n)] = w[sucast(L - 1 - n)] = (1 + cos(num::pi / per * (t - per))) / 2;
     }
     return w;
 }
@@ -87,7 +166,7 @@ double kaiser_fn(int n, int L, double beta)
     }
     const double N_over_2 = (double(L) - 1) / 2;
 
-  #ifdef HAVE_CYL_BESSEL_I
+  #if MEADOW_HAS_CYL_BESSEL_I == 1
     using std::cyl_bessel_i;
   #else
     using boost::math::cyl_bessel_i;
@@ -106,6 +185,120 @@ double hann_poisson_fn(int n, int L, double alpha)
     return 0.5 * (1 - cos(2 * num::pi * n / N)) * exp(-alpha * abs(N - 2 * n) / N);
 }
 
+namespace
+{
+// Number of terms of the power series I0(x) = sum(((x/2)^(2k) / (k!)^2), k = 0..) needed for double precision for
+// all arguments in [0, x_max]. The terms are positive, so the truncation is the only significant error.
+int besseli0_terms(double x_max)
+{
+    const double q = square(x_max / 2);
+    double term = 1, sum = 1;
+    int k = 1;
+    for (; term > sum * 1e-17; ++k) {
+        term *= q / square(k);
+        sum += term;
+    }
+    return k;
+}
+
+// I0(x) with the first `n_terms` terms of the power series, the same number of steps for every `x`, so that loops
+// calling it vectorize.
+double besseli0_series(double x, int n_terms)
+{
+    const double q = square(x / 2);
+    double term = 1, sum = 1;
+    for (int k = 1; k < n_terms; ++k) {
+        term *= q / square(k);
+        sum += term;
+    }
+    return sum;
+}
+} // namespace
+
+std::vector<double> kaiser(int L, double beta)
+{
+    CHECK(L >= 0 && beta >= 0);
+    vector<double> w(sucast(L));
+    if (L == 1) {
+        w[0] = 1.0;
+        return w;
+    }
+    const auto N = sucast(L);
+    const double N_over_2 = (double(L) - 1) / 2;
+    const int n_terms = besseli0_terms(beta);
+    const double inv_i0_beta = 1 / besseli0_series(beta, n_terms);
+    for (size_t n = 0; n < (N + 1) / 2; ++n) {
+        const double r = (ifcast<double>(n) - N_over_2) / N_over_2;
+        w[n] = besseli0_series(beta * sqrt(1 - square(r)), n_terms) * inv_i0_beta;
+    }
+    for (size_t n = (N + 1) / 2; n < N; ++n) {
+        w[n] = w[N - 1 - n];
+    }
+    return w;
+}
+
+std::span<const double> cached_window(WindowType type, int L, double param)
+{
+    // Windows without a parameter are stored with param = 0.
+    switch (type) {
+    case WindowType::rectwin:
+    case WindowType::blackman:
+    case WindowType::hann:
+    case WindowType::hamming:
+    case WindowType::flattopwin:
+        param = 0.0;
+        break;
+    case WindowType::gausswin:
+    case WindowType::tukeywin:
+    case WindowType::kaiser:
+        break;
+    }
+    // A NaN would break the ordering of the map's keys.
+    CHECK(std::isfinite(param));
+    const auto key = std::tuple(type, L, param);
+
+    // std::map never moves its elements, the vectors are never modified after insertion.
+    static std::shared_mutex mutex;
+    static std::map<std::tuple<WindowType, int, double>, vector<double>> cache;
+    {
+        std::shared_lock lock(mutex);
+        if (auto it = cache.find(key); it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    vector<double> w;
+    switch (type) {
+    case WindowType::rectwin:
+        w.assign(sucast(L), 1.0);
+        break;
+    case WindowType::blackman:
+        w = blackman(L);
+        break;
+    case WindowType::gausswin:
+        w = gausswin(L, param);
+        break;
+    case WindowType::hann:
+        w = hann(L);
+        break;
+    case WindowType::hamming:
+        w = hamming(L);
+        break;
+    case WindowType::flattopwin:
+        w = flattopwin(L);
+        break;
+    case WindowType::tukeywin:
+        w = tukeywin(L, param);
+        break;
+    case WindowType::kaiser:
+        w = kaiser(L, param);
+        break;
+    }
+
+    std::unique_lock lock(mutex);
+    return cache.try_emplace(key, MOVE(w)).first->second;
+}
+
 double sum(const vector<double>& xs)
 {
     return std::accumulate(BEGIN_END(xs), 0.0);
@@ -156,6 +349,118 @@ template array<float, 2> polyfit1(span<const float> xs, span<const float> ys);
 
 template array<double, 2> polyfit1(span<const double> xs, span<const double> ys);
 
+template<class T>
+SlidingPolyfit1<T>::SlidingPolyfit1(size_t window)
+    : xs(window)
+    , ys(window)
+{
+    CHECK(window >= 2);
+}
+
+template<class T>
+void SlidingPolyfit1<T>::push(T x, T y)
+{
+    if (count == xs.size()) {
+        const T u = xs[head] - origin, v = ys[head];
+        sx -= u;
+        sx2 -= square(u);
+        sy -= v;
+        sxy -= u * v;
+    } else {
+        if (count == 0) {
+            origin = x;
+        }
+        ++count;
+    }
+    xs[head] = x;
+    ys[head] = y;
+    head = (head + 1) % xs.size();
+    const T u = x - origin;
+    sx += u;
+    sx2 += square(u);
+    sy += y;
+    sxy += u * y;
+    if (++pushes_since_resum == xs.size()) {
+        resum();
+    }
+}
+
+template<class T>
+void SlidingPolyfit1<T>::resum()
+{
+    const size_t capacity = xs.size();
+    const size_t oldest = (head + capacity - count) % capacity;
+    origin = xs[oldest];
+    sx = sx2 = sy = sxy = 0;
+    for (size_t k = 0; k < count; ++k) {
+        const size_t i = (oldest + k) % capacity;
+        const T u = xs[i] - origin;
+        sx += u;
+        sx2 += square(u);
+        sy += ys[i];
+        sxy += u * ys[i];
+    }
+    pushes_since_resum = 0;
+}
+
+template<class T>
+array<T, 2> SlidingPolyfit1<T>::fit() const
+{
+    // Same as `polyfit1` with x - origin, then the intercept is moved back to x = 0.
+    assert(count >= 2);
+    const T N = ifcast<T>(count);
+    const T det = N * sx2 - square(sx);
+    const T slope = (N * sxy - sx * sy) / det;
+    const T intercept = (sx2 * sy - sx * sxy) / det;
+    return array<T, 2>{slope, intercept - slope * origin};
+}
+
+template<class T>
+void SlidingPolyfit1<T>::reset()
+{
+    head = count = pushes_since_resum = 0;
+    origin = sx = sx2 = sy = sxy = 0;
+}
+
+template<class T>
+size_t SlidingPolyfit1<T>::size() const
+{
+    return count;
+}
+
+template<class T>
+bool SlidingPolyfit1<T>::full() const
+{
+    return count == xs.size();
+}
+
+template class SlidingPolyfit1<float>;
+
+template class SlidingPolyfit1<double>;
+
+template<class T>
+std::vector<array<T, 2>> sliding_polyfit1(span<const T> xs, span<const T> ys, size_t window)
+{
+    CHECK(ys.size() == xs.size());
+    std::vector<array<T, 2>> r;
+    if (xs.size() < window) {
+        return r;
+    }
+    r.reserve(xs.size() - window + 1);
+    SlidingPolyfit1<T> fitter(window);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        fitter.push(xs[i], ys[i]);
+        if (fitter.full()) {
+            r.push_back(fitter.fit());
+        }
+    }
+    return r;
+}
+
+template std::vector<array<float, 2>> sliding_polyfit1(span<const float> xs, span<const float> ys, size_t window);
+
+template std::vector<array<double, 2>> sliding_polyfit1(span<const double> xs, span<const double> ys, size_t window);
+
 template<class C, class X>
 decltype(std::declval<C>() * std::declval<X>()) polyval(std::span<const C> cs, X x)
 {
@@ -179,6 +484,156 @@ template std::complex<double> polyval(std::span<const std::complex<double>> cs,
 
 template std::complex<double> polyval(std::span<const double> cs, std::complex<double> x);
 
+namespace
+{
+// Number of x values evaluated side by side by the batch `polyval`.
+constexpr size_t k_polyval_lanes = 8;
+} // namespace
+
+namespace detail
+{
+template<class C, class X>
+void polyval_horner(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+)
+{
+    using R = decltype(std::declval<C>() * std::declval<X>());
+    CHECK(out.size() == xs.size());
+    if (cs.empty()) {
+        ra::fill(out, R(0));
+        return;
+    }
+    size_t i = 0;
+    for (; i + k_polyval_lanes <= xs.size(); i += k_polyval_lanes) {
+        std::array<R, k_polyval_lanes> s;
+        for (size_t l = 0; l < k_polyval_lanes; ++l) {
+            s[l] = cs.front();
+        }
+        for (size_t k = 1; k < cs.size(); ++k) {
+            for (size_t l = 0; l < k_polyval_lanes; ++l) {
+                s[l] = s[l] * xs[i + l] + cs[k];
+            }
+        }
+        ra::copy(s, out.begin() + uscast(i));
+    }
+    for (; i < xs.size(); ++i) {
+        out[i] = polyval(cs, xs[i]);
+    }
+}
+
+template<class C, class X>
+void polyval_estrin(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+)
+{
+    using R = decltype(std::declval<C>() * std::declval<X>());
+    CHECK(out.size() == xs.size());
+    const size_t N = cs.size();
+    if (N < 4) {
+        polyval_horner(cs, xs, out);
+        return;
+    }
+    // Coefficient of x^j, zero above the degree so that all four Pr have the same number of terms.
+    const auto c = [cs, N](size_t j) {
+        return j < N ? R(cs[N - 1 - j]) : R(0);
+    };
+    const size_t n_terms = (N + 3) / 4;
+    size_t i = 0;
+    for (; i + k_polyval_lanes <= xs.size(); i += k_polyval_lanes) {
+        std::array<X, k_polyval_lanes> x, x2, x4;
+        for (size_t l = 0; l < k_polyval_lanes; ++l) {
+            x[l] = xs[i + l];
+            x2[l] = x[l] * x[l];
+            x4[l] = x2[l] * x2[l];
+        }
+        std::array<std::array<R, k_polyval_lanes>, 4> p;
+        for (size_t r = 0; r < 4; ++r) {
+            const R top = c(4 * (n_terms - 1) + r);
+            for (size_t l = 0; l < k_polyval_lanes; ++l) {
+                p[r][l] = top;
+            }
+        }
+        for (size_t m = n_terms - 1; m-- > 0;) {
+            for (size_t r = 0; r < 4; ++r) {
+                const R cr = c(4 * m + r);
+                for (size_t l = 0; l < k_polyval_lanes; ++l) {
+                    p[r][l] = p[r][l] * x4[l] + cr;
+                }
+            }
+        }
+        for (size_t l = 0; l < k_polyval_lanes; ++l) {
+            out[i + l] = (p[0][l] + x[l] * p[1][l]) + x2[l] * (p[2][l] + x[l] * p[3][l]);
+        }
+    }
+    for (; i < xs.size(); ++i) {
+        out[i] = polyval(cs, xs[i]);
+    }
+}
+
+template void polyval_horner(std::span<const float> cs, std::span<const float> xs, std::span<float> out);
+
+template void polyval_horner(std::span<const double> cs, std::span<const double> xs, std::span<double> out);
+
+template void polyval_horner(
+  std::span<const std::complex<double>> cs,
+  std::span<const std::complex<double>> xs,
+  std::span<std::complex<double>> out
+);
+
+template void polyval_horner(
+  std::span<const double> cs,
+  std::span<const std::complex<double>> xs,
+  std::span<std::complex<double>> out
+);
+
+template void polyval_estrin(std::span<const float> cs, std::span<const float> xs, std::span<float> out);
+
+template void polyval_estrin(std::span<const double> cs, std::span<const double> xs, std::span<double> out);
+
+template void polyval_estrin(
+  std::span<const std::complex<double>> cs,
+  std::span<const std::complex<double>> xs,
+  std::span<std::complex<double>> out
+);
+
+template void polyval_estrin(
+  std::span<const double> cs,
+  std::span<const std::complex<double>> xs,
+  std::span<std::complex<double>> out
+);
+} // namespace detail
+
+template<class C, class X>
+void polyval(
+  std::span<const C> cs,
+  std::span<const X> xs,
+  std::span<decltype(std::declval<C>() * std::declval<X>())> out
+)
+{
+    if (cs.size() > k_polyval_estrin_min_degree) {
+        detail::polyval_estrin(cs, xs, out);
+    } else {
+        detail::polyval_horner(cs, xs, out);
+    }
+}
+
+template void polyval(std::span<const float> cs, std::span<const float> xs, std::span<float> out);
+
+template void polyval(std::span<const double> cs, std::span<const double> xs, std::span<double> out);
+
+template void polyval(
+  std::span<const std::complex<double>> cs,
+  std::span<const std::complex<double>> xs,
+  std::span<std::complex<double>> out
+);
+
+template void
+polyval(std::span<const double> cs, std::span<const std::complex<double>> xs, std::span<std::complex<double>> out);
+
 template<class T>
 std::vector<T> polyder(std::span<const T> cs)
 {
@@ -225,7 +680,7 @@ std::inplace_vector<T, 2> real_roots2(std::span<const T, 3> cs)
         return {};
     }
     if (D > 0) {
-        const auto sqrt_D = sqrt(D);
+        const auto sqrt_D = std::sqrt(D);
         auto r = std::inplace_vector<T, 2>({(-cs[1] - sqrt_D) / (2 * cs[0]), (-cs[1] + sqrt_D) / (2 * cs[0])});
         if (r[0] > r[1]) {
             std::swap(r[0], r[1]);
@@ -239,6 +694,162 @@ template std::inplace_vector<float, 2> real_roots2(std::span<const float, 3> cs)
 
 template std::inplace_vector<double, 2> real_roots2(std::span<const double, 3> cs);
 
+namespace
+{
+// Ordering with NaNs after all numbers.
+template<class T>
+bool less_nan_last(T a, T b)
+{
+    return a < b || (b != b && a == a);
+}
+
+template<class T>
+void sort2_nan_last(T& a, T& b)
+{
+    const bool swap = less_nan_last(b, a);
+    const T lo = swap ? b : a, hi = swap ? a : b;
+    a = lo;
+    b = hi;
+}
+
+// Roots of a*x^2 + b*x + c, ascending, NaNs if they are complex. `q` avoids the cancellation in -b +- sqrt(D).
+template<class T>
+array<T, 2> quadratic_roots(T a, T b, T c)
+{
+    const T sqrt_D = std::sqrt(square(b) - 4 * a * c);
+    const T q = -(b + std::copysign(sqrt_D, b)) / 2;
+    T r1 = q / a, r2 = q != 0 ? c / q : r1;
+    sort2_nan_last(r1, r2);
+    return {r1, r2};
+}
+
+// One Newton step on the monic polynomial with coefficients cs[1..] (cs[0] = 1), skipped where the derivative is 0.
+template<class T, size_t N>
+T newton_step(const array<T, N>& cs, T x)
+{
+    T f = 1, df = 0;
+    for (size_t i = 1; i < N; ++i) {
+        df = df * x + f;
+        f = f * x + cs[i];
+    }
+    return df != 0 ? x - f / df : x;
+}
+
+template<class T>
+array<T, 3> cubic_roots(T a, T b, T c, T d)
+{
+    const array<T, 4> monic{1, b / a, c / a, d / a};
+    // x = t - b/3 gives t^3 + p*t + q = 0.
+    const T b3 = monic[1] / 3;
+    const T p3 = (monic[2] - 3 * square(b3)) / 3;
+    const T q2 = ((2 * square(b3) - monic[2]) * b3 + monic[3]) / 2;
+    const T disc = square(q2) + p3 * square(p3);
+
+    // Three real roots (disc <= 0, p < 0): t_k = 2 * s * cos(theta - 2*pi*k/3), Viete's trigonometric form.
+    const T s = std::sqrt(std::max(-p3, T(0)));
+    const T cos_3theta = s > 0 ? std::clamp(-q2 / (s * square(s)), T(-1), T(1)) : T(0);
+    const T theta = std::acos(cos_3theta) / 3;
+    constexpr T two_pi_3 = static_cast<T>(2 * num::pi / 3);
+    const array<T, 3> trig{
+      2 * s * std::cos(theta + two_pi_3) - b3, 2 * s * std::cos(theta - two_pi_3) - b3, 2 * s * std::cos(theta) - b3
+    };
+
+    // One real root: Cardano's formula, with the sign of u chosen to avoid cancellation.
+    const T u = -std::copysign(std::cbrt(std::abs(q2) + std::sqrt(std::max(disc, T(0)))), q2);
+    const T cardano = (u != 0 ? u - p3 / u : T(0)) - b3;
+
+    const bool three = disc <= 0;
+    constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+    array<T, 3> r{three ? trig[0] : cardano, three ? trig[1] : nan, three ? trig[2] : nan};
+    for (auto& x : r) {
+        x = newton_step(monic, x);
+    }
+    sort2_nan_last(r[0], r[1]);
+    sort2_nan_last(r[1], r[2]);
+    sort2_nan_last(r[0], r[1]);
+    return r;
+}
+
+template<class T>
+array<T, 4> quartic_roots(T a, T b, T c, T d, T e)
+{
+    const array<T, 5> monic{1, b / a, c / a, d / a, e / a};
+    // x = y - b/4 gives y^4 + p*y^2 + q*y + r = 0.
+    const T b4 = monic[1] / 4;
+    const T p = monic[2] - 6 * square(b4);
+    const T q = monic[3] - 2 * monic[2] * b4 + 8 * b4 * square(b4);
+    const T r = monic[4] - monic[3] * b4 + monic[2] * square(b4) - 3 * square(square(b4));
+
+    // Ferrari: with m >= 0 the largest root of m^3 + p*m^2 + (p^2/4 - r)*m - q^2/8, the quartic is
+    // (y^2 + s*y + A) * (y^2 - s*y + B), s = sqrt(2m), A and B = p/2 + m -+ q / (2s). For m = 0 (then q = 0) it is
+    // biquadratic, A and B = (p -+ sqrt(p^2 - 4r)) / 2.
+    const auto resolvent = cubic_roots<T>(1, p, square(p) / 4 - r, -square(q) / 8);
+    const auto or_0 = [](T x) {
+        return x == x ? x : T(0);
+    };
+    const T m = std::max({T(0), or_0(resolvent[0]), or_0(resolvent[1]), or_0(resolvent[2])});
+    const T s = std::sqrt(2 * m);
+    const T half_diff = s > 0 ? q / (2 * s) : std::sqrt(square(p) - 4 * r) / 2;
+    const auto y12 = quadratic_roots<T>(1, s, p / 2 + m - half_diff);
+    const auto y34 = quadratic_roots<T>(1, -s, p / 2 + m + half_diff);
+
+    array<T, 4> x{y12[0] - b4, y12[1] - b4, y34[0] - b4, y34[1] - b4};
+    for (auto& xi : x) {
+        xi = newton_step(monic, xi);
+    }
+    // Sorting network for 4.
+    sort2_nan_last(x[0], x[1]);
+    sort2_nan_last(x[2], x[3]);
+    sort2_nan_last(x[0], x[2]);
+    sort2_nan_last(x[1], x[3]);
+    sort2_nan_last(x[1], x[2]);
+    return x;
+}
+} // namespace
+
+template<class T>
+void real_roots2(std::span<const T> cs, std::span<T> roots)
+{
+    CHECK(cs.size() % 3 == 0 && roots.size() == cs.size() / 3 * 2);
+    for (size_t i = 0; i < cs.size() / 3; ++i) {
+        const auto r = quadratic_roots(cs[3 * i], cs[3 * i + 1], cs[3 * i + 2]);
+        roots[2 * i] = r[0];
+        roots[2 * i + 1] = r[1];
+    }
+}
+
+template<class T>
+void real_roots3(std::span<const T> cs, std::span<T> roots)
+{
+    CHECK(cs.size() % 4 == 0 && roots.size() == cs.size() / 4 * 3);
+    for (size_t i = 0; i < cs.size() / 4; ++i) {
+        const auto r = cubic_roots(cs[4 * i], cs[4 * i + 1], cs[4 * i + 2], cs[4 * i + 3]);
+        ra::copy(r, roots.begin() + uscast(3 * i));
+    }
+}
+
+template<class T>
+void real_roots4(std::span<const T> cs, std::span<T> roots)
+{
+    CHECK(cs.size() % 5 == 0 && roots.size() == cs.size() / 5 * 4);
+    for (size_t i = 0; i < cs.size() / 5; ++i) {
+        const auto r = quartic_roots(cs[5 * i], cs[5 * i + 1], cs[5 * i + 2], cs[5 * i + 3], cs[5 * i + 4]);
+        ra::copy(r, roots.begin() + uscast(4 * i));
+    }
+}
+
+template void real_roots2(std::span<const float> cs, std::span<float> roots);
+
+template void real_roots2(std::span<const double> cs, std::span<double> roots);
+
+template void real_roots3(std::span<const float> cs, std::span<float> roots);
+
+template void real_roots3(std::span<const double> cs, std::span<double> roots);
+
+template void real_roots4(std::span<const float> cs, std::span<float> roots);
+
+template void real_roots4(std::span<const double> cs, std::span<double> roots);
+
 #if MEADOW_HAS_EIGEN == 1
 std::vector<double> polyfit(
   std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> xs,
@@ -280,6 +891,164 @@ std::vector<double> polyfit(
 
     return coeffs;
 }
+
+PolyFitter::PolyFitter(std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> xs, int degree_arg)
+    : n_coeffs(sucast(degree_arg + 1))
+    , n_samples(xs.extent(0))
+{
+    CHECK(degree_arg >= 0 && n_samples >= n_coeffs);
+    const auto n = iicast<Eigen::Index>(n_samples);
+    const auto m = iicast<Eigen::Index>(n_coeffs);
+    Eigen::MatrixXd A(n, m);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const auto x = xs[sucast(i)];
+        double xp = 1.0;
+        for (Eigen::Index p = 0; p < m; ++p) {
+            A(i, p) = xp;
+            xp *= x;
+        }
+    }
+
+    // A * P = Q * R gives pinv(A) = P * inv(R) * Q', using only the first m columns of Q.
+    const auto qr = A.colPivHouseholderQr();
+    const Eigen::MatrixXd thin_q = qr.householderQ() * Eigen::MatrixXd::Identity(n, m);
+    const Eigen::MatrixXd r_inv_qt =
+      qr.matrixR().topLeftCorner(m, m).triangularView<Eigen::Upper>().solve(thin_q.transpose());
+    const Eigen::MatrixXd ascending = qr.colsPermutation() * r_inv_qt;
+
+    pinv.resize(n_coeffs * n_samples);
+    Eigen::Map<Eigen::MatrixXd> descending(pinv.data(), m, n);
+    descending = ascending.colwise().reverse();
+}
+
+void PolyFitter::fit(
+  std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> ys,
+  std::mdspan<double, std::dextents<size_t, 2>, std::layout_stride> cs,
+  size_t n_threads
+) const
+{
+    CHECK(ys.extent(0) == n_samples && cs.extent(0) == ys.extent(1) && cs.extent(1) == n_coeffs);
+    using Strided = Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>;
+    const auto m = iicast<Eigen::Index>(n_coeffs);
+    const auto n = iicast<Eigen::Index>(n_samples);
+    const Eigen::Map<const Eigen::MatrixXd> p(pinv.data(), m, n);
+    const auto ys_stride = [&ys](size_t r) {
+        return iicast<Eigen::Index>(ys.stride(r));
+    };
+    const auto cs_stride = [&cs](size_t r) {
+        return iicast<Eigen::Index>(cs.stride(r));
+    };
+    parallel_for_chunks(ys.extent(1), n_threads, [&](size_t begin, size_t end) {
+        if (begin == end) {
+            return;
+        }
+        const auto n_series = iicast<Eigen::Index>(end - begin);
+        // The series as columns and their coefficients as columns, in the layouts of `ys` and `cs`.
+        const Eigen::Map<const Eigen::MatrixXd, 0, Strided> y(
+          &ys[0, begin], n, n_series, Strided(ys_stride(1), ys_stride(0))
+        );
+        Eigen::Map<Eigen::MatrixXd, 0, Strided> c(&cs[begin, 0], m, n_series, Strided(cs_stride(0), cs_stride(1)));
+        c.noalias() = p * y;
+    });
+}
+
+std::vector<double>
+PolyFitter::fit(std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> ys, size_t n_threads) const
+{
+    std::vector<double> cs(ys.extent(1) * n_coeffs);
+    using Extents = std::dextents<size_t, 2>;
+    const std::layout_stride::mapping<Extents> row_major(
+      Extents(ys.extent(1), n_coeffs), std::array<size_t, 2>{n_coeffs, 1}
+    );
+    fit(ys, std::mdspan<double, Extents, std::layout_stride>(cs.data(), row_major), n_threads);
+    return cs;
+}
+
+std::vector<double> PolyFitter::fit(std::mdspan<const double, std::dextents<size_t, 1>, std::layout_stride> ys) const
+{
+    using Extents = std::dextents<size_t, 2>;
+    const std::layout_stride::mapping<Extents> column(Extents(ys.extent(0), 1), std::array<size_t, 2>{ys.stride(0), 1});
+    return fit(std::mdspan<const double, Extents, std::layout_stride>(ys.data_handle(), column), 1);
+}
+
+int PolyFitter::degree() const
+{
+    return iicast<int>(n_coeffs) - 1;
+}
+
+size_t PolyFitter::size() const
+{
+    return n_samples;
+}
+
+namespace
+{
+// Parlett-Reinsch balancing, like MATLAB's `eig` does by default: scales the rows and columns by powers of 2 so that
+// their norms are close. The eigenvalues don't change, but their rounding errors, proportional to the norm of the
+// matrix, shrink. The scaling by powers of 2 is exact.
+void balance(Eigen::MatrixXd& A)
+{
+    constexpr double radix = 2;
+    const Eigen::Index n = A.rows();
+    for (bool converged = false; !converged;) {
+        converged = true;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            double c = A.col(i).cwiseAbs().sum() - std::abs(A(i, i));
+            double r = A.row(i).cwiseAbs().sum() - std::abs(A(i, i));
+            if (c == 0 || r == 0) {
+                continue;
+            }
+            const double s = c + r;
+            double f = 1;
+            while (c < r / radix) {
+                f *= radix;
+                c *= radix * radix;
+            }
+            while (c > r * radix) {
+                f /= radix;
+                c /= radix * radix;
+            }
+            if ((c + r) / f < 0.95 * s) {
+                converged = false;
+                A.row(i) /= f;
+                A.col(i) *= f;
+            }
+        }
+    }
+}
+} // namespace
+
+std::vector<std::complex<double>> roots(std::span<const double> cs)
+{
+    size_t first = 0, last = cs.size();
+    while (first < last && cs[first] == 0) {
+        ++first;
+    }
+    if (first == last) {
+        return {};
+    }
+    while (cs[last - 1] == 0) {
+        --last;
+    }
+    std::vector<std::complex<double>> r;
+    if (last - first >= 2) {
+        // Companion matrix: the first row is -cs[1..n] / cs[0], ones on the subdiagonal.
+        const auto n = iicast<Eigen::Index>(last - first - 1);
+        Eigen::MatrixXd C = Eigen::MatrixXd::Zero(n, n);
+        for (Eigen::Index j = 0; j < n; ++j) {
+            C(0, j) = -cs[first + 1 + sucast(j)] / cs[first];
+        }
+        for (Eigen::Index i = 1; i < n; ++i) {
+            C(i, i - 1) = 1;
+        }
+        balance(C);
+        const Eigen::EigenSolver<Eigen::MatrixXd> solver(C, false);
+        const auto& eigenvalues = solver.eigenvalues();
+        r.assign(eigenvalues.begin(), eigenvalues.end());
+    }
+    r.resize(r.size() + cs.size() - last, 0.0);
+    return r;
+}
 #endif
 
 std::vector<double> linspace(double x1, double x2, size_t n)
@@ -352,44 +1121,25 @@ double datenum(int y, int m, int d)
 
 namespace
 {
-struct DeviationSums {
-    double sxx, sxy, syy;
-};
-
 // Divisor of the deviation sums for the normalization argument w.
 double normalizationDivisor(size_t n, int w)
 {
     CHECK(w == 0 || w == 1);
     return ifcast<double>(n) - (w == 0 ? 1.0 : 0.0);
 }
-
-// Sums of the squared and cross deviations from the means of xs and ys.
-DeviationSums deviationSums(span<const double> xs, span<const double> ys)
-{
-    CHECK(xs.size() == ys.size());
-    const auto mean_x = mean(xs);
-    const auto mean_y = mean(ys);
-    DeviationSums r{0, 0, 0};
-    for (auto&& [x, y] : vi::zip(xs, ys)) {
-        const auto dx = x - mean_x;
-        const auto dy = y - mean_y;
-        r.sxx += square(dx);
-        r.sxy += dx * dy;
-        r.syy += square(dy);
-    }
-    return r;
-}
 } // namespace
 
 double corr(span<const double> xs, span<const double> ys)
 {
-    const auto s = deviationSums(xs, ys);
+    CHECK(xs.size() == ys.size());
+    const auto s = ::detail::deviation_sums(xs, ys);
     return s.sxy / sqrt(s.sxx * s.syy);
 }
 
 array<array<double, 2>, 2> cov(span<const double> xs, span<const double> ys, int w)
 {
-    const auto s = deviationSums(xs, ys);
+    CHECK(xs.size() == ys.size());
+    const auto s = ::detail::deviation_sums(xs, ys);
     const auto norm = normalizationDivisor(xs.size(), w);
     return {
       array<double, 2>{s.sxx / norm, s.sxy / norm},
@@ -397,19 +1147,315 @@ array<array<double, 2>, 2> cov(span<const double> xs, span<const double> ys, int
     };
 }
 
+BivariateStats describe(span<const double> xs, span<const double> ys, int w)
+{
+    CHECK(xs.size() == ys.size());
+    const auto s = ::detail::deviation_sums(xs, ys);
+    const auto norm = normalizationDivisor(xs.size(), w);
+    return BivariateStats{
+      .mean_x = s.mean_x,
+      .mean_y = s.mean_y,
+      .var_x = s.sxx / norm,
+      .var_y = s.syy / norm,
+      .cov = s.sxy / norm,
+      .corr = s.sxy / sqrt(s.sxx * s.syy)
+    };
+}
+
 double var(span<const double> xs, int w)
 {
     const auto norm = normalizationDivisor(xs.size(), w);
-    const auto mean_x = mean(xs);
-    double sxx = 0;
-    for (auto x : xs) {
-        sxx += square(x - mean_x);
-    }
-    return sxx / norm;
+    return ::detail::deviation_sums(xs).sxx / norm;
 }
 
 double std(span<const double> xs, int w)
 {
     return sqrt(var(xs, w));
 }
+
+MovingStat::MovingStat(size_t window)
+    : xs(window)
+{
+    CHECK(window >= 1);
+}
+
+void MovingStat::push(double x)
+{
+    assert(std::isfinite(x));
+    if (count == xs.size()) {
+        pop();
+    }
+    if (count == 0) {
+        origin = x;
+        s = s2 = 0;
+    }
+    xs[head] = x;
+    head = (head + 1) % xs.size();
+    ++count;
+    const uint64_t index = num_pushed++;
+    while (!mins.empty() && mins.back().value >= x) {
+        mins.pop_back();
+    }
+    mins.push_back({index, x});
+    while (!maxs.empty() && maxs.back().value <= x) {
+        maxs.pop_back();
+    }
+    maxs.push_back({index, x});
+    update_sums(x, origin);
+}
+
+void MovingStat::pop()
+{
+    assert(count > 0);
+    const size_t oldest = (head + xs.size() - count) % xs.size();
+    const uint64_t oldest_index = num_pushed - count;
+    --count;
+    if (mins.front().index == oldest_index) {
+        mins.pop_front();
+    }
+    if (maxs.front().index == oldest_index) {
+        maxs.pop_front();
+    }
+    update_sums(origin, xs[oldest]);
+}
+
+void MovingStat::update_sums(double entering, double leaving)
+{
+    // Pass x = origin for no entering or leaving sample, it contributes 0 to both sums.
+    const double u = entering - origin, v = leaving - origin;
+    s += u - v;
+    s2 += square(u) - square(v);
+    if (++updates_since_resum >= xs.size()) {
+        resum();
+    }
+}
+
+void MovingStat::resum()
+{
+    const size_t capacity = xs.size();
+    const size_t oldest = (head + capacity - count) % capacity;
+    origin = count == 0 ? 0 : xs[oldest];
+    s = s2 = 0;
+    for (size_t k = 0; k < count; ++k) {
+        const double u = xs[(oldest + k) % capacity] - origin;
+        s += u;
+        s2 += square(u);
+    }
+    updates_since_resum = 0;
+}
+
+void MovingStat::reset()
+{
+    head = count = updates_since_resum = 0;
+    num_pushed = 0;
+    origin = s = s2 = 0;
+    mins.clear();
+    maxs.clear();
+}
+
+size_t MovingStat::size() const
+{
+    return count;
+}
+
+bool MovingStat::full() const
+{
+    return count == xs.size();
+}
+
+double MovingStat::sum() const
+{
+    return s + ifcast<double>(count) * origin;
+}
+
+double MovingStat::mean() const
+{
+    assert(count > 0);
+    return count == 0 ? NAN : origin + s / ifcast<double>(count);
+}
+
+double MovingStat::min() const
+{
+    assert(count > 0);
+    return count == 0 ? NAN : mins.front().value;
+}
+
+double MovingStat::max() const
+{
+    assert(count > 0);
+    return count == 0 ? NAN : maxs.front().value;
+}
+
+double MovingStat::var(int w) const
+{
+    CHECK(w == 0 || w == 1);
+    assert(count > 0);
+    if (count <= 1) {
+        return count == 0 ? NAN : 0.0;
+    }
+    const auto n = ifcast<double>(count);
+    // The sums are of deviations from a sample of the window, so the subtraction doesn't cancel catastrophically.
+    return std::max(0.0, s2 - square(s) / n) / normalizationDivisor(count, w);
+}
+
+double MovingStat::std(int w) const
+{
+    return sqrt(var(w));
+}
+
+MovingMedian::MovingMedian(size_t window)
+    : xs(window)
+{
+    CHECK(window >= 1);
+}
+
+void MovingMedian::push(double x)
+{
+    assert(std::isfinite(x));
+    if (count == xs.size()) {
+        pop();
+    }
+    xs[head] = x;
+    head = (head + 1) % xs.size();
+    ++count;
+    if (lower.empty() || x <= *lower.rbegin()) {
+        lower.insert(x);
+    } else {
+        upper.insert(x);
+    }
+    rebalance();
+}
+
+void MovingMedian::pop()
+{
+    assert(count > 0);
+    const double x = xs[(head + xs.size() - count) % xs.size()];
+    --count;
+    if (x <= *lower.rbegin()) {
+        lower.erase(lower.find(x));
+    } else {
+        upper.erase(upper.find(x));
+    }
+    rebalance();
+}
+
+void MovingMedian::rebalance()
+{
+    if (lower.size() > upper.size() + 1) {
+        upper.insert(lower.extract(std::prev(lower.end())));
+    } else if (upper.size() > lower.size()) {
+        lower.insert(upper.extract(upper.begin()));
+    }
+}
+
+void MovingMedian::reset()
+{
+    head = count = 0;
+    lower.clear();
+    upper.clear();
+}
+
+size_t MovingMedian::size() const
+{
+    return count;
+}
+
+bool MovingMedian::full() const
+{
+    return count == xs.size();
+}
+
+double MovingMedian::median() const
+{
+    assert(count > 0);
+    if (count == 0) {
+        return NAN;
+    }
+    const double lo = *lower.rbegin();
+    return lower.size() > upper.size() ? lo : lo + (*upper.begin() - lo) / 2;
+}
+
+namespace
+{
+// Calls fn(window) for each sample of xs, with `window` holding the samples of its truncated moving window.
+template<class Window, class Fn>
+std::vector<double> movingWindow(span<const double> xs, MovWindow mw, Window& window, const Fn& fn)
+{
+    std::vector<double> r(xs.size());
+    size_t next = 0; // Next sample to push.
+    for (size_t i = 0; i < xs.size(); ++i) {
+        if (i > mw.before) {
+            window.pop();
+        }
+        for (const size_t end = std::min(xs.size(), i + mw.after + 1); next < end; ++next) {
+            window.push(xs[next]);
+        }
+        r[i] = fn(window);
+    }
+    return r;
+}
+
+// Capacity of the window for xs: a window longer than xs never holds more than all of it, as MATLAB clamps it.
+size_t movingCapacity(span<const double> xs, MovWindow mw)
+{
+    return std::max<size_t>(1, std::min(mw.before + mw.after + 1, xs.size()));
+}
+
+template<class Fn>
+std::vector<double> movingStat(span<const double> xs, MovWindow mw, const Fn& fn)
+{
+    MovingStat window(movingCapacity(xs, mw));
+    return movingWindow(xs, mw, window, fn);
+}
+} // namespace
+
+std::vector<double> movsum(span<const double> xs, MovWindow window)
+{
+    return movingStat(xs, window, [](const MovingStat& ms) {
+        return ms.sum();
+    });
+}
+
+std::vector<double> movmean(span<const double> xs, MovWindow window)
+{
+    return movingStat(xs, window, [](const MovingStat& ms) {
+        return ms.mean();
+    });
+}
+
+std::vector<double> movmin(span<const double> xs, MovWindow window)
+{
+    return movingStat(xs, window, [](const MovingStat& ms) {
+        return ms.min();
+    });
+}
+
+std::vector<double> movmax(span<const double> xs, MovWindow window)
+{
+    return movingStat(xs, window, [](const MovingStat& ms) {
+        return ms.max();
+    });
+}
+
+std::vector<double> movvar(span<const double> xs, MovWindow window, int w)
+{
+    return movingStat(xs, window, [w](const MovingStat& ms) {
+        return ms.var(w);
+    });
+}
+
+std::vector<double> movstd(span<const double> xs, MovWindow window, int w)
+{
+    return movingStat(xs, window, [w](const MovingStat& ms) {
+        return ms.std(w);
+    });
+}
+
+std::vector<double> movmedian(span<const double> xs, MovWindow window)
+{
+    MovingMedian mm(movingCapacity(xs, window));
+    return movingWindow(xs, window, mm, [](const MovingMedian& m) {
+        return m.median();
+    });
+}
 } // namespace matlab
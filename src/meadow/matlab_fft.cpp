@@ -0,0 +1,341 @@
+#include "meadow/matlab_fft.h"
+
+#include "meadow/cppext.h"
+#include "meadow/math.h"
+
+#include <bit>
+#include <mutex>
+
+namespace matlab
+{
+
+namespace
+{
+// Complex multiplication without the NaN/infinity handling of std::complex, which blocks vectorization.
+std::complex<double> cmul(std::complex<double> a, std::complex<double> b)
+{
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+// -i * a
+std::complex<double> mul_minus_i(std::complex<double> a)
+{
+    return {a.imag(), -a.real()};
+}
+
+// Return the cached object of size `n` from `cache`, constructing it outside the lock, so that constructors may
+// call `get` for other sizes.
+template<class T>
+std::shared_ptr<const T> get_cached(std::unordered_map<size_t, std::shared_ptr<const T>>& cache, size_t n)
+{
+    static std::mutex mutex;
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = cache.find(n); it != cache.end()) {
+            return it->second;
+        }
+    }
+    auto plan = std::make_shared<const T>(n);
+    std::lock_guard lock(mutex);
+    return cache.try_emplace(n, MOVE(plan)).first->second;
+}
+} // namespace
+
+FftPlan::FftPlan(size_t n_arg)
+    : n(n_arg)
+{
+    CHECK(n >= 1);
+    if (std::has_single_bit(n)) {
+        const auto log2n = iicast<size_t>(std::countr_zero(n));
+        bit_reversed.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < log2n; ++b) {
+                r |= ((i >> b) & 1) << (log2n - 1 - b);
+            }
+            bit_reversed[i] = r;
+        }
+        twiddles.resize(n / 2);
+        for (size_t k = 0; k < n / 2; ++k) {
+            twiddles[k] = std::polar(1.0, -2 * num::pi * ifcast<double>(k) / ifcast<double>(n));
+        }
+    } else {
+        const size_t m = std::bit_ceil(2 * n - 1);
+        pow2_plan = get(m);
+        chirp.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            // Reduce k^2 modulo 2n to keep the angle small and accurate.
+            const auto k2 = (k * k) % (2 * n);
+            chirp[k] = std::polar(1.0, -num::pi * ifcast<double>(k2) / ifcast<double>(n));
+        }
+        chirp_ft.assign(m, 0.0);
+        chirp_ft[0] = std::conj(chirp[0]);
+        for (size_t k = 1; k < n; ++k) {
+            chirp_ft[k] = chirp_ft[m - k] = std::conj(chirp[k]);
+        }
+        pow2_plan->forward(chirp_ft);
+    }
+}
+
+std::shared_ptr<const FftPlan> FftPlan::get(size_t n)
+{
+    static std::unordered_map<size_t, std::shared_ptr<const FftPlan>> cache;
+    return get_cached(cache, n);
+}
+
+size_t FftPlan::size() const
+{
+    return n;
+}
+
+void FftPlan::forward(std::span<std::complex<double>> x) const
+{
+    CHECK(x.size() == n);
+    if (pow2_plan) {
+        forward_bluestein(x);
+    } else {
+        forward_pow2(x);
+    }
+}
+
+void FftPlan::inverse(std::span<std::complex<double>> x) const
+{
+    // ifft(x) = conj(fft(conj(x))) / n
+    for (auto& c : x) {
+        c = std::conj(c);
+    }
+    forward(x);
+    const double scale = 1.0 / ifcast<double>(n);
+    for (auto& c : x) {
+        c = std::conj(c) * scale;
+    }
+}
+
+void FftPlan::forward_pow2(std::span<std::complex<double>> x) const
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (i < bit_reversed[i]) {
+            std::swap(x[i], x[bit_reversed[i]]);
+        }
+    }
+
+    // Length of the sub-transforms done so far.
+    size_t len = 1;
+    if (is_odd(std::countr_zero(n))) {
+        for (size_t i = 0; i < n; i += 2) {
+            const auto a = x[i], b = x[i + 1];
+            x[i] = a + b;
+            x[i + 1] = a - b;
+        }
+        len = 2;
+    }
+
+    // Radix-4 passes, each fusing two radix-2 passes: the four sub-transforms of size q at [j, j+q, j+2q, j+3q]
+    // become two of size 2q, then one of size 4q.
+    for (; len < n; len *= 4) {
+        const size_t q = len;
+        const size_t stride2 = n / (2 * q); // Twiddle stride for size 2q.
+        const size_t stride4 = n / (4 * q); // Twiddle stride for size 4q.
+        for (size_t base = 0; base < n; base += 4 * q) {
+            auto* p = x.data() + base;
+            for (size_t j = 0; j < q; ++j) {
+                const auto w2 = twiddles[j * stride2];
+                const auto w4 = twiddles[j * stride4];
+                const auto a = p[j], b = p[j + q], c = p[j + 2 * q], d = p[j + 3 * q];
+
+                const auto t = cmul(w2, b);
+                const auto u = cmul(w2, d);
+                const auto a1 = a + t, b1 = a - t, c1 = c + u, d1 = c - u;
+
+                const auto v = cmul(w4, c1);
+                const auto s = mul_minus_i(cmul(w4, d1)); // w4 * exp(-pi*i/2)
+                p[j] = a1 + v;
+                p[j + 2 * q] = a1 - v;
+                p[j + q] = b1 + s;
+                p[j + 3 * q] = b1 - s;
+            }
+        }
+    }
+}
+
+void FftPlan::forward_bluestein(std::span<std::complex<double>> x) const
+{
+    // X[k] = chirp[k] * sum(x[j] * chirp[j] * conj(chirp[k - j])), the sum is a convolution done with FFTs of size m.
+    thread_local std::vector<std::complex<double>> work;
+    const size_t m = pow2_plan->size();
+    work.assign(m, 0.0);
+    for (size_t k = 0; k < n; ++k) {
+        work[k] = cmul(x[k], chirp[k]);
+    }
+    pow2_plan->forward(work);
+    for (size_t k = 0; k < m; ++k) {
+        work[k] = cmul(work[k], chirp_ft[k]);
+    }
+    pow2_plan->inverse(work);
+    for (size_t k = 0; k < n; ++k) {
+        x[k] = cmul(work[k], chirp[k]);
+    }
+}
+
+RealFftPlan::RealFftPlan(size_t n_arg)
+    : n(n_arg)
+{
+    CHECK(n >= 1);
+    if (is_even(n)) {
+        plan = FftPlan::get(n / 2);
+        twiddles.resize(n / 4 + 1);
+        for (size_t k = 0; k < twiddles.size(); ++k) {
+            twiddles[k] = std::polar(1.0, -2 * num::pi * ifcast<double>(k) / ifcast<double>(n));
+        }
+    } else {
+        plan = FftPlan::get(n);
+    }
+}
+
+std::shared_ptr<const RealFftPlan> RealFftPlan::get(size_t n)
+{
+    static std::unordered_map<size_t, std::shared_ptr<const RealFftPlan>> cache;
+    return get_cached(cache, n);
+}
+
+size_t RealFftPlan::size() const
+{
+    return n;
+}
+
+void RealFftPlan::forward(std::span<const double> x, std::span<std::complex<double>> X) const
+{
+    CHECK(x.size() == n && X.size() == n / 2 + 1);
+    if (is_odd(n)) {
+        thread_local std::vector<std::complex<double>> work;
+        work.assign(x.begin(), x.end());
+        plan->forward(work);
+        ra::copy(work.begin(), work.begin() + uscast(X.size()), X.begin());
+        return;
+    }
+
+    // Transform z[k] = x[2k] + i*x[2k+1] in place in X, then separate the transforms of the even and odd samples:
+    //     E[k] = (Z[k] + conj(Z[h-k])) / 2,  O[k] = -i * (Z[k] - conj(Z[h-k])) / 2,  X[k] = E[k] + W^k * O[k]
+    // The pair k, h - k is done together, using X[h-k] = conj(E[k] - W^k * O[k]).
+    const size_t h = n / 2;
+    for (size_t k = 0; k < h; ++k) {
+        X[k] = {x[2 * k], x[2 * k + 1]};
+    }
+    plan->forward(X.first(h));
+    const auto z0 = X[0];
+    X[0] = z0.real() + z0.imag();
+    X[h] = z0.real() - z0.imag();
+    for (size_t k = 1; k <= h / 2; ++k) {
+        const auto zk = X[k], zhk = X[h - k];
+        const auto e = 0.5 * (zk + std::conj(zhk));
+        const auto o = mul_minus_i(0.5 * (zk - std::conj(zhk)));
+        const auto wo = cmul(twiddles[k], o);
+        X[k] = e + wo;
+        if (k != h - k) {
+            X[h - k] = std::conj(e - wo);
+        }
+    }
+}
+
+void RealFftPlan::inverse(std::span<const std::complex<double>> X, std::span<double> x) const
+{
+    CHECK(x.size() == n && X.size() == n / 2 + 1);
+    thread_local std::vector<std::complex<double>> work;
+    if (is_odd(n)) {
+        work.resize(n);
+        work[0] = X[0].real();
+        for (size_t k = 1; k < X.size(); ++k) {
+            work[k] = X[k];
+            work[n - k] = std::conj(X[k]);
+        }
+        plan->inverse(work);
+        for (size_t k = 0; k < n; ++k) {
+            x[k] = work[k].real();
+        }
+        return;
+    }
+
+    // Reverse of `forward`: E[k] = (X[k] + conj(X[h-k])) / 2, O[k] = conj(W^k) * (X[k] - conj(X[h-k])) / 2,
+    // Z[k] = E[k] + i*O[k].
+    const size_t h = n / 2;
+    work.resize(h);
+    {
+        const double x0 = X[0].real(), xh = X[h].real();
+        work[0] = {0.5 * (x0 + xh), 0.5 * (x0 - xh)};
+    }
+    for (size_t k = 1; k < h; ++k) {
+        const auto xk = X[k], xhk = std::conj(X[h - k]);
+        const auto w = k <= h / 2 ? twiddles[k] : -std::conj(twiddles[h - k]); // W^k = -conj(W^(h-k))
+        const auto e = 0.5 * (xk + xhk);
+        const auto o = cmul(std::conj(w), 0.5 * (xk - xhk));
+        work[k] = e + std::complex<double>(-o.imag(), o.real());
+    }
+    plan->inverse(work);
+    for (size_t k = 0; k < h; ++k) {
+        x[2 * k] = work[k].real();
+        x[2 * k + 1] = work[k].imag();
+    }
+}
+
+std::vector<std::complex<double>> fft(std::span<const std::complex<double>> x, size_t n)
+{
+    std::vector<std::complex<double>> X(n);
+    ra::copy(x.first(std::min(n, x.size())), X.begin());
+    if (n > 0) {
+        FftPlan::get(n)->forward(X);
+    }
+    return X;
+}
+
+std::vector<std::complex<double>> fft(std::span<const double> x, size_t n)
+{
+    std::vector<double> padded(n);
+    ra::copy(x.first(std::min(n, x.size())), padded.begin());
+    auto X = rfft(padded);
+    // The second half is the conjugate of the first half, mirrored.
+    X.resize(n);
+    for (size_t k = n / 2 + 1; k < n; ++k) {
+        X[k] = std::conj(X[n - k]);
+    }
+    return X;
+}
+
+std::vector<std::complex<double>> fft(std::span<const std::complex<double>> x)
+{
+    return fft(x, x.size());
+}
+
+std::vector<std::complex<double>> fft(std::span<const double> x)
+{
+    return fft(x, x.size());
+}
+
+std::vector<std::complex<double>> ifft(std::span<const std::complex<double>> X)
+{
+    std::vector<std::complex<double>> x(X.begin(), X.end());
+    if (!x.empty()) {
+        FftPlan::get(x.size())->inverse(x);
+    }
+    return x;
+}
+
+std::vector<std::complex<double>> rfft(std::span<const double> x)
+{
+    if (x.empty()) {
+        return {};
+    }
+    std::vector<std::complex<double>> X(x.size() / 2 + 1);
+    RealFftPlan::get(x.size())->forward(x, X);
+    return X;
+}
+
+std::vector<double> irfft(std::span<const std::complex<double>> X, size_t n)
+{
+    std::vector<double> x(n);
+    if (n > 0) {
+        RealFftPlan::get(n)->inverse(X, x);
+    }
+    return x;
+}
+
+} // namespace matlab
@@ -1,10 +1,22 @@
 #include "meadow/matlab_signal.h"
 #include "meadow/matlab.h"
+#include "meadow/math.h"
+#include "meadow/matlab_fft.h"
+#include "meadow/parallel.h"
 
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <complex>
+#include <map>
+#include <mutex>
 #include <numbers>
+#include <numeric>
+
+#if MEADOW_HAS_EIGEN == 1
+  #include "meadow/eigen_dense.h"
+#endif
 
 #ifdef __clang__
   #pragma clang diagnostic ignored "-Wsign-conversion"
@@ -13,245 +25,742 @@
 namespace matlab
 {
 
-namespace
+namespace detail
 {
 
-// Analog Butterworth prototype poles of order N, on the unit circle in the left half-plane.
-// p_k = exp(j * π * (2k + N - 1) / (2N)), k = 1..N
-std::vector<std::complex<double>> analog_proto_poles(int order)
+void poly_core(std::span<const std::complex<double>> roots, std::span<std::complex<double>> work, std::span<double> c)
 {
-    std::vector<std::complex<double>> poles(order);
-    for (int k = 0; k < order; ++k) {
-        double angle = std::numbers::pi * (2.0 * (k + 1) + order - 1) / (2.0 * order);
-        poles[k] = std::polar(1.0, angle);
+    const size_t n = roots.size();
+    CHECK(c.size() == n + 1 && work.size() >= n + 1);
+    // Multiply by (z - r) in place, in descending powers of z.
+    work[0] = 1.0;
+    for (size_t i = 0; i < n; ++i) {
+        const auto r = roots[i];
+        work[i + 1] = -(work[i] * r);
+        for (size_t j = i; j >= 1; --j)
+            work[j] -= work[j - 1] * r;
     }
-    return poles;
+    for (size_t i = 0; i <= n; ++i)
+        c[i] = work[i].real();
+}
+
+} // namespace detail
+
+ZeroPoleGain butter_zpk(int order, const FilterType::V& filter)
+{
+    assert(order >= 1);
+    const auto n = sucast(detail::butter_digital_order(order, filter));
+    std::vector<cx::complex> z(n), p(n);
+    const double k = detail::butter_zpk_core(order, filter, z, p);
+    ZeroPoleGain zpk{.z = std::vector<std::complex<double>>(n), .p = std::vector<std::complex<double>>(n), .k = k};
+    for (size_t i = 0; i < n; ++i) {
+        zpk.z[i] = {z[i].re, z[i].im};
+        zpk.p[i] = {p[i].re, p[i].im};
+    }
+    return zpk;
+}
+
+TransferFunctionCoeffs butter(int order, const FilterType::V& filter)
+{
+    return zp2tf(butter_zpk(order, filter));
 }
 
-// Bilinear transform: s-domain → z-domain (T = 1).
-// z = (2 + s) / (2 - s)
-std::complex<double> bilinear(std::complex<double> s)
+TransferFunctionCoeffs zp2tf(const ZeroPoleGain& zpk)
+{
+    const size_t n = std::max(zpk.z.size(), zpk.p.size());
+    std::vector<double> b(n + 1, 0.0), a(n + 1, 0.0);
+    std::vector<std::complex<double>> work(n + 1);
+    const auto b_tail = std::span(b).last(zpk.z.size() + 1);
+    detail::poly_core(zpk.z, work, b_tail);
+    for (auto& c : b_tail)
+        c *= zpk.k;
+    detail::poly_core(zpk.p, work, std::span(a).last(zpk.p.size() + 1));
+    return {MOVE(b), MOVE(a)};
+}
+
+#if MEADOW_HAS_EIGEN == 1
+ZeroPoleGain tf2zp(std::span<const double> b, std::span<const double> a)
+{
+    const auto first_nonzero = [](std::span<const double> p) {
+        return ra::find_if(p, [](double c) {
+            return c != 0;
+        });
+    };
+    const auto a0 = first_nonzero(a);
+    CHECK(a0 != a.end());
+    const auto b0 = first_nonzero(b);
+    return {.z = roots(b), .p = roots(a), .k = b0 == b.end() ? 0.0 : *b0 / *a0};
+}
+#endif
+
+SecondOrderSections butter_sos(int order, const FilterType::V& filter)
+{
+    return zp2sos(butter_zpk(order, filter));
+}
+
+namespace
 {
-    return (2.0 + s) / (2.0 - s);
+bool is_real_root(std::complex<double> r)
+{
+    return std::abs(r.imag()) <= 100 * std::numeric_limits<double>::epsilon() * std::abs(r);
 }
 
-// Build monic polynomial from roots: prod(z - r_k).
-// Returns coefficients in descending powers of z: [1, c_{N-1}, ..., c_0].
-std::vector<std::complex<double>> poly_from_roots(const std::vector<std::complex<double>>& roots)
+// Keep the real roots (with zero imaginary part) and one root of each conjugate pair, the one with positive
+// imaginary part.
+std::vector<std::complex<double>> real_and_upper_roots(const std::vector<std::complex<double>>& roots)
 {
-    std::vector<std::complex<double>> poly = {1.0};
-    for (auto r : roots) {
-        std::vector<std::complex<double>> next(poly.size() + 1, 0.0);
-        for (size_t i = 0; i < poly.size(); ++i) {
-            next[i] += poly[i];
-            next[i + 1] -= poly[i] * r;
+    std::vector<std::complex<double>> r;
+    for (auto x : roots) {
+        if (is_real_root(x)) {
+            r.push_back(x.real());
+        } else if (x.imag() > 0) {
+            r.push_back(x);
         }
-        poly = std::move(next);
     }
-    return poly;
+    return r;
 }
 
-std::complex<double> polyval(const std::vector<std::complex<double>>& c, const std::complex<double>& z)
+size_t count_real_roots(const std::vector<std::complex<double>>& roots)
 {
-    return matlab::polyval(span<const std::complex<double>>(c), z);
+    return iicast<size_t>(ra::count_if(roots, is_real_root));
 }
 
-std::vector<double> real_coeffs(const std::vector<std::complex<double>>& c)
+enum class RootKind {
+    real,
+    complex,
+    any
+};
+
+// Index of the root of the given kind, nearest to `x`. Precond: there is at least one such root.
+size_t nearest_root_index(const std::vector<std::complex<double>>& roots, std::complex<double> x, RootKind kind)
 {
-    std::vector<double> r(c.size());
-    for (size_t i = 0; i < c.size(); ++i)
-        r[i] = c[i].real();
+    size_t best = roots.size();
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if ((kind == RootKind::real && !is_real_root(roots[i]))
+            || (kind == RootKind::complex && is_real_root(roots[i]))) {
+            continue;
+        }
+        if (best == roots.size() || std::abs(roots[i] - x) < std::abs(roots[best] - x)) {
+            best = i;
+        }
+    }
+    CHECK(best < roots.size());
+    return best;
+}
+
+std::complex<double> take_root(std::vector<std::complex<double>>& roots, size_t i)
+{
+    const auto r = roots[i];
+    roots.erase(roots.begin() + uscast(i));
     return r;
 }
 
-// Assemble ButterworthCoeffs from digital zeros/poles and a reference point z_ref
-// at which |H(z_ref)| is normalized to 1.
-TransferFunctionCoeffs make_coeffs(
-  const std::vector<std::complex<double>>& z_zeros,
-  const std::vector<std::complex<double>>& z_poles,
-  std::complex<double> z_ref
-)
+// Second-order section with the given zeros and poles (at most 2 of each), zero-padded at the front.
+std::array<double, 6> single_sos(std::span<const std::complex<double>> zs, std::span<const std::complex<double>> ps)
 {
-    auto b = poly_from_roots(z_zeros);
-    auto a = poly_from_roots(z_poles);
-    const double K = std::abs(polyval(a, z_ref) / polyval(b, z_ref));
-    for (auto& c : b)
-        c *= K;
-    return {real_coeffs(b), real_coeffs(a)};
+    std::array<double, 6> section{};
+    std::array<std::complex<double>, 3> work;
+    detail::poly_core(zs, work, std::span(section).subspan(2 - zs.size(), zs.size() + 1));
+    detail::poly_core(ps, work, std::span(section).subspan(5 - ps.size(), ps.size() + 1));
+    return section;
 }
 
-TransferFunctionCoeffs butter_lp(int order, double Wn)
+} // namespace
+
+SecondOrderSections zp2sos(const ZeroPoleGain& zpk)
 {
-    auto poles = analog_proto_poles(order);
-    const double wc = 2.0 * std::tan(std::numbers::pi * Wn / 2.0);
-    for (auto& p : poles)
-        p *= wc;
+    const size_t n_sections = (std::max(zpk.z.size(), zpk.p.size()) + 1) / 2;
+    if (n_sections == 0) {
+        return {{std::array<double, 6>{1.0, 0.0, 0.0, 1.0, 0.0, 0.0}}, zpk.k};
+    }
 
-    std::vector<std::complex<double>> z_poles(order), z_zeros(order, {-1.0, 0.0});
-    for (int i = 0; i < order; ++i)
-        z_poles[i] = bilinear(poles[i]);
+    // Pad with roots at the origin to 2 * n_sections zeros and poles.
+    auto z_all = zpk.z, p_all = zpk.p;
+    z_all.resize(2 * n_sections, 0.0);
+    p_all.resize(2 * n_sections, 0.0);
+    auto z = real_and_upper_roots(z_all);
+    auto p = real_and_upper_roots(p_all);
 
-    return make_coeffs(z_zeros, z_poles, {1.0, 0.0}); // normalize DC gain to 1
+    // Going backwards from the last section, take the pole closest to the unit circle and pair it with the
+    // nearest zeros.
+    std::vector<std::array<double, 6>> sos(n_sections);
+    for (size_t si = n_sections; si-- > 0;) {
+        const auto p1_it = ra::min_element(p, {}, [](auto x) {
+            return std::abs(1.0 - std::abs(x));
+        });
+        const auto p1 = take_root(p, iicast<size_t>(p1_it - p.begin()));
+        const bool p1_real = is_real_root(p1);
+
+        if (p1_real && count_real_roots(p) == 0) {
+            // First-order section.
+            const auto z1 = take_root(z, nearest_root_index(z, p1, RootKind::real));
+            const std::complex<double> zs[] = {z1, 0.0}, ps[] = {p1, 0.0};
+            sos[si] = single_sos(zs, ps);
+        } else if (p.size() + 1 == z.size() && !p1_real && count_real_roots(p) == 1 && count_real_roots(z) == 1) {
+            // The remaining single real pole must pair with the single real zero, so take a complex zero pair.
+            const auto z1 = take_root(z, nearest_root_index(z, p1, RootKind::complex));
+            const std::complex<double> zs[] = {z1, std::conj(z1)}, ps[] = {p1, std::conj(p1)};
+            sos[si] = single_sos(zs, ps);
+        } else {
+            std::complex<double> p2;
+            if (p1_real) {
+                const auto p2_it = ra::min_element(p, {}, [](auto x) {
+                    return is_real_root(x) ? std::abs(std::abs(x) - 1.0) : INFINITY;
+                });
+                p2 = take_root(p, iicast<size_t>(p2_it - p.begin()));
+            } else {
+                p2 = std::conj(p1);
+            }
+            const std::complex<double> ps[] = {p1, p2};
+            if (z.empty()) {
+                sos[si] = single_sos({}, ps);
+            } else {
+                const auto z1 = take_root(z, nearest_root_index(z, p1, RootKind::any));
+                if (!is_real_root(z1)) {
+                    const std::complex<double> zs[] = {z1, std::conj(z1)};
+                    sos[si] = single_sos(zs, ps);
+                } else if (z.empty()) {
+                    const std::complex<double> zs[] = {z1};
+                    sos[si] = single_sos(zs, ps);
+                } else {
+                    const auto z2 = take_root(z, nearest_root_index(z, p1, RootKind::real));
+                    const std::complex<double> zs[] = {z1, z2};
+                    sos[si] = single_sos(zs, ps);
+                }
+            }
+        }
+    }
+    CHECK(p.empty() && z.empty());
+    return {MOVE(sos), zpk.k};
 }
 
-TransferFunctionCoeffs butter_hp(int order, double Wn)
+template<std::floating_point T>
+SosFilter<T>::SosFilter(const SecondOrderSections& sos)
+    : g(static_cast<T>(sos.g))
 {
-    auto poles = analog_proto_poles(order);
-    const double wc = 2.0 * std::tan(std::numbers::pi * Wn / 2.0);
-    for (auto& p : poles)
-        p = wc / p; // LP→HP: s → wc/s
+    sections.reserve(sos.sos.size());
+    for (auto& s : sos.sos) {
+        CHECK(s[3] != 0);
+        const auto c = [&s](size_t i) {
+            return static_cast<T>(s[i] / s[3]);
+        };
+        sections.push_back(Section{c(0), c(1), c(2), c(4), c(5), 0, 0});
+    }
+}
 
-    std::vector<std::complex<double>> z_poles(order), z_zeros(order, {1.0, 0.0});
-    for (int i = 0; i < order; ++i)
-        z_poles[i] = bilinear(poles[i]);
+template<std::floating_point T>
+void SosFilter<T>::process(std::span<const T> x, std::span<T> y)
+{
+    CHECK(x.size() == y.size());
+    const size_t n = x.size();
+    for (size_t i = 0; i < n; ++i)
+        y[i] = g * x[i];
+    // Run each section over the whole block: the recurrence of a single biquad stays in registers.
+    for (auto& s : sections) {
+        T s1 = s.s1, s2 = s.s2;
+        for (size_t i = 0; i < n; ++i) {
+            const T xi = y[i];
+            const T yi = s.b0 * xi + s1;
+            s1 = s.b1 * xi - s.a1 * yi + s2;
+            s2 = s.b2 * xi - s.a2 * yi;
+            y[i] = yi;
+        }
+        s.s1 = s1;
+        s.s2 = s2;
+    }
+}
 
-    return make_coeffs(z_zeros, z_poles, {-1.0, 0.0}); // normalize Nyquist gain to 1
+template<std::floating_point T>
+T SosFilter<T>::operator()(T x)
+{
+    T y = x;
+    process(std::span<const T>(&y, 1), std::span<T>(&y, 1));
+    return y;
 }
 
-TransferFunctionCoeffs butter_bp(int order, double Wn1, double Wn2)
+template<std::floating_point T>
+void SosFilter<T>::reset()
 {
-    auto proto = analog_proto_poles(order);
-    const double w1 = 2.0 * std::tan(std::numbers::pi * Wn1 / 2.0);
-    const double w2 = 2.0 * std::tan(std::numbers::pi * Wn2 / 2.0);
-    const double w0 = std::sqrt(w1 * w2);
-    const double Bw = w2 - w1;
+    for (auto& s : sections) {
+        s.s1 = s.s2 = 0;
+    }
+}
+
+template class SosFilter<float>;
+template class SosFilter<double>;
+
+std::complex<double> freqz(std::span<const double> b, std::span<const double> a, double w)
+{
+    std::complex<double> h;
+    freqz(b, a, std::span<const double>(&w, 1), std::span<std::complex<double>>(&h, 1));
+    return h;
+}
 
-    // LP→BP: each s_k solves s² - s_k*Bw*s + w0² = 0 → two poles
-    std::vector<std::complex<double>> z_poles;
-    z_poles.reserve(2 * order);
-    for (auto s : proto) {
-        const auto q = s * (Bw / 2.0);
-        const auto sq = std::sqrt(q * q - w0 * w0);
-        z_poles.push_back(bilinear(q + sq));
-        z_poles.push_back(bilinear(q - sq));
+std::vector<double> FrequencyResponse::magnitude() const
+{
+    std::vector<double> r(h.size());
+    for (size_t i = 0; i < h.size(); ++i)
+        r[i] = std::abs(h[i]);
+    return r;
+}
+
+std::vector<double> FrequencyResponse::phase() const
+{
+    std::vector<double> r(h.size());
+    for (size_t i = 0; i < h.size(); ++i)
+        r[i] = std::arg(h[i]);
+    return r;
+}
+
+namespace
+{
+// Horner's method on `lanes` points at once, on separate real and imaginary arrays so that the loop over the lanes
+// vectorizes (std::complex multiplication has NaN-handling branches).
+template<size_t lanes>
+void polyval_lanes(
+  std::span<const double> cs,
+  const std::array<double, lanes>& zr,
+  const std::array<double, lanes>& zi,
+  std::array<double, lanes>& re,
+  std::array<double, lanes>& im
+)
+{
+    re.fill(0.0);
+    im.fill(0.0);
+    for (const double c : cs) {
+        for (size_t l = 0; l < lanes; ++l) {
+            const double r = re[l] * zr[l] - im[l] * zi[l] + c;
+            im[l] = re[l] * zi[l] + im[l] * zr[l];
+            re[l] = r;
+        }
     }
+}
+} // namespace
 
-    // N zeros at z=+1 (ω=0) and N zeros at z=-1 (ω=π)
-    std::vector<std::complex<double>> z_zeros(2 * order);
-    for (int i = 0; i < order; ++i)
-        z_zeros[i] = {1.0, 0.0};
-    for (int i = order; i < 2 * order; ++i)
-        z_zeros[i] = {-1.0, 0.0};
+void freqz(
+  std::span<const double> b,
+  std::span<const double> a,
+  std::span<const double> w,
+  std::span<std::complex<double>> h
+)
+{
+    CHECK(w.size() == h.size());
+    // H(e^jw) = sum(b[k] * e^(-jwk)) / sum(a[k] * e^(-jwk))
+    //         = e^(jw * (size(a) - size(b))) * polyval(b, e^jw) / polyval(a, e^jw)
+    const double size_diff = ifcast<double>(a.size()) - ifcast<double>(b.size());
+    constexpr size_t lanes = 8;
+    std::array<double, lanes> zr, zi, br, bi, ar, ai;
+    for (size_t base = 0; base < w.size(); base += lanes) {
+        const size_t n = std::min(lanes, w.size() - base);
+        for (size_t l = 0; l < lanes; ++l) {
+            const double wl = l < n ? w[base + l] : 0.0;
+            zr[l] = std::cos(wl);
+            zi[l] = std::sin(wl);
+        }
+        polyval_lanes(b, zr, zi, br, bi);
+        polyval_lanes(a, zr, zi, ar, ai);
+        for (size_t l = 0; l < n; ++l) {
+            auto hl = std::complex<double>(br[l], bi[l]) / std::complex<double>(ar[l], ai[l]);
+            if (size_diff != 0) {
+                hl *= std::polar(1.0, w[base + l] * size_diff);
+            }
+            h[base + l] = hl;
+        }
+    }
+}
 
-    // Normalize at the bilinear-transformed analog center frequency
-    const std::complex<double> s_center = {0.0, w0};
-    const auto z_center = (2.0 + s_center) / (2.0 - s_center);
-    return make_coeffs(z_zeros, z_poles, z_center);
+FrequencyResponse freqz(std::span<const double> b, std::span<const double> a, std::span<const double> w)
+{
+    FrequencyResponse r{std::vector<std::complex<double>>(w.size()), std::vector<double>(w.begin(), w.end())};
+    freqz(b, a, w, r.h);
+    return r;
 }
 
-TransferFunctionCoeffs butter_bs(int order, double Wn1, double Wn2)
+FrequencyResponse freqz(std::span<const double> b, std::span<const double> a, size_t n)
 {
-    auto proto = analog_proto_poles(order);
-    const double w1 = 2.0 * std::tan(std::numbers::pi * Wn1 / 2.0);
-    const double w2 = 2.0 * std::tan(std::numbers::pi * Wn2 / 2.0);
-    const double w0 = std::sqrt(w1 * w2);
-    const double Bw = w2 - w1;
+    // With w[k] = 2*pi*k / (2n), sum(b[j] * exp(-i*w[k]*j)) is the k-th bin of the 2n-point DFT of b, wrapped around
+    // when b is longer than 2n.
+    FrequencyResponse r{std::vector<std::complex<double>>(n), std::vector<double>(n)};
+    if (n == 0) {
+        return r;
+    }
+    for (size_t i = 0; i < n; ++i)
+        r.w[i] = std::numbers::pi * ifcast<double>(i) / ifcast<double>(n);
+    const auto plan = RealFftPlan::get(2 * n);
+    std::vector<double> wrapped(2 * n);
+    std::vector<std::complex<double>> B(n + 1), A(n + 1);
+    auto dft = [&](std::span<const double> p, std::span<std::complex<double>> P) {
+        ra::fill(wrapped, 0.0);
+        for (size_t i = 0; i < p.size(); ++i)
+            wrapped[i % (2 * n)] += p[i];
+        plan->forward(wrapped, P);
+    };
+    dft(b, B);
+    dft(a, A);
+    for (size_t i = 0; i < n; ++i)
+        r.h[i] = B[i] / A[i];
+    return r;
+}
 
-    // LP→BS: each s_k solves s_k*s² - Bw*s + s_k*w0² = 0
-    // s = Bw/(2*s_k) ± sqrt((Bw/(2*s_k))² - w0²)
-    std::vector<std::complex<double>> z_poles;
-    z_poles.reserve(2 * order);
-    for (auto s : proto) {
-        const auto q = Bw / (2.0 * s);
-        const auto sq = std::sqrt(q * q - w0 * w0);
-        z_poles.push_back(bilinear(q + sq));
-        z_poles.push_back(bilinear(q - sq));
+FilterResult
+filter(std::span<const double> b, std::span<const double> a, std::span<const double> x, std::span<const double> zi)
+{
+    IirFilter f(b, a);
+    if (!zi.empty()) {
+        f.set_state(zi);
     }
+    FilterResult r;
+    r.y.resize(x.size());
+    f.process(x, r.y);
+    r.zf.assign(f.state().begin(), f.state().end());
+    return r;
+}
+
+template<std::floating_point T>
+IirFilter<T>::IirFilter(std::span<const double> b_arg, std::span<const double> a_arg)
+{
+    CHECK(!a_arg.empty() && a_arg[0] != 0);
+    CHECK(!b_arg.empty());
+    const size_t n = std::max(a_arg.size(), b_arg.size());
+    b.assign(n, 0);
+    a.assign(n, 0);
+    for (size_t i = 0; i < b_arg.size(); ++i)
+        b[i] = static_cast<T>(b_arg[i] / a_arg[0]);
+    for (size_t i = 0; i < a_arg.size(); ++i)
+        a[i] = static_cast<T>(a_arg[i] / a_arg[0]);
+    z.assign(n - 1, 0);
+}
+
+template<std::floating_point T>
+IirFilter<T>::IirFilter(const TransferFunctionCoeffs& tf)
+    : IirFilter(tf.b, tf.a)
+{
+}
 
-    // Transmission zeros at ±j*w0 in analog → conjugate pair on unit circle in z
-    const auto z_notch = bilinear({0.0, w0});
-    std::vector<std::complex<double>> z_zeros;
-    z_zeros.reserve(2 * order);
-    for (int i = 0; i < order; ++i) {
-        z_zeros.push_back(z_notch);
-        z_zeros.push_back(std::conj(z_notch));
+template<std::floating_point T>
+void IirFilter<T>::process(std::span<const T> x, std::span<T> y)
+{
+    CHECK(x.size() == y.size());
+    const size_t n = z.size();
+    if (n == 0) {
+        for (size_t i = 0; i < x.size(); ++i)
+            y[i] = b[0] * x[i];
+        return;
+    }
+    for (size_t i = 0; i < x.size(); ++i) {
+        const T xi = x[i];
+        const T yi = b[0] * xi + z[0];
+        for (size_t k = 1; k < n; ++k)
+            z[k - 1] = b[k] * xi + z[k] - a[k] * yi;
+        z[n - 1] = b[n] * xi - a[n] * yi;
+        y[i] = yi;
     }
+}
+
+template<std::floating_point T>
+T IirFilter<T>::operator()(T x)
+{
+    T y = x;
+    process(std::span<const T>(&y, 1), std::span<T>(&y, 1));
+    return y;
+}
 
-    return make_coeffs(z_zeros, z_poles, {1.0, 0.0}); // normalize DC gain to 1
+template<std::floating_point T>
+void IirFilter<T>::reset()
+{
+    ra::fill(z, T(0));
 }
 
-std::vector<double> poly_mul(const std::vector<double>& p, const std::vector<double>& q)
+template<std::floating_point T>
+size_t IirFilter<T>::order() const
+{
+    return z.size();
+}
+
+template<std::floating_point T>
+std::span<const T> IirFilter<T>::state() const
+{
+    return z;
+}
+
+template<std::floating_point T>
+std::span<const T> IirFilter<T>::numerator() const
+{
+    return b;
+}
+
+template<std::floating_point T>
+std::span<const T> IirFilter<T>::denominator() const
+{
+    return a;
+}
+
+template<std::floating_point T>
+void IirFilter<T>::set_state(std::span<const T> zi)
+{
+    CHECK(zi.size() == z.size());
+    ra::copy(zi, z.begin());
+}
+
+template class IirFilter<float>;
+template class IirFilter<double>;
+
+template<std::floating_point T>
+IirFilterBank<T>::IirFilterBank(std::span<const double> b_arg, std::span<const double> a_arg, size_t n_channels_arg)
+    : channels(n_channels_arg)
+{
+    const IirFilter<T> prototype(b_arg, a_arg);
+    b.assign(prototype.numerator().begin(), prototype.numerator().end());
+    a.assign(prototype.denominator().begin(), prototype.denominator().end());
+    z.assign((channels + k_lanes - 1) / k_lanes * k_lanes * prototype.order(), T(0));
+}
+
+template<std::floating_point T>
+IirFilterBank<T>::IirFilterBank(const TransferFunctionCoeffs& tf, size_t n_channels_arg)
+    : IirFilterBank(tf.b, tf.a, n_channels_arg)
+{
+}
+
+template<std::floating_point T>
+void IirFilterBank<T>::process(
+  std::mdspan<const T, std::dextents<size_t, 2>, std::layout_stride> xs,
+  std::mdspan<T, std::dextents<size_t, 2>, std::layout_stride> ys
+)
 {
-    std::vector<double> result(p.size() + q.size() - 1, 0.0);
-    for (size_t i = 0; i < p.size(); ++i) {
-        for (size_t j = 0; j < q.size(); ++j) {
-            result[i + j] += p[i] * q[j];
+    CHECK(xs.extent(0) == ys.extent(0) && xs.extent(1) == channels && ys.extent(1) == channels);
+    const size_t n = order();
+    // One group of channels at a time, over all samples, so that its state stays in registers or L1. The lane loops
+    // have a constant trip count and no dependency between the lanes.
+    for (size_t c0 = 0; c0 < channels; c0 += k_lanes) {
+        const size_t lanes = std::min(k_lanes, channels - c0);
+        T* zg = z.data() + c0 * n;
+        for (size_t i = 0; i < xs.extent(0); ++i) {
+            std::array<T, k_lanes> x{}, y;
+            for (size_t l = 0; l < lanes; ++l)
+                x[l] = xs[i, c0 + l];
+            if (n == 0) {
+                for (size_t l = 0; l < k_lanes; ++l)
+                    y[l] = b[0] * x[l];
+            } else {
+                for (size_t l = 0; l < k_lanes; ++l)
+                    y[l] = b[0] * x[l] + zg[l];
+                for (size_t k = 1; k < n; ++k) {
+                    T* zk = zg + (k - 1) * k_lanes;
+                    for (size_t l = 0; l < k_lanes; ++l)
+                        zk[l] = b[k] * x[l] + zk[l + k_lanes] - a[k] * y[l];
+                }
+                T* zn = zg + (n - 1) * k_lanes;
+                for (size_t l = 0; l < k_lanes; ++l)
+                    zn[l] = b[n] * x[l] - a[n] * y[l];
+            }
+            for (size_t l = 0; l < lanes; ++l)
+                ys[i, c0 + l] = y[l];
         }
     }
-    return result;
 }
 
+template<std::floating_point T>
+void IirFilterBank<T>::reset()
+{
+    ra::fill(z, T(0));
+}
+
+template<std::floating_point T>
+size_t IirFilterBank<T>::n_channels() const
+{
+    return channels;
+}
+
+template<std::floating_point T>
+size_t IirFilterBank<T>::order() const
+{
+    return b.size() - 1;
+}
+
+template class IirFilterBank<float>;
+template class IirFilterBank<double>;
+
+namespace
+{
+// Initial state of `filter` for the steady-state of the step response (MATLAB's filtfilt, SciPy's lfilter_zi).
+// Solves zi = A * zi + B for the companion matrix A of `a` with the explicit formulas.
+// `b` and `a` are normalized to a[0] = 1 and padded to the same size.
+std::vector<double> step_steady_state(std::span<const double> b, std::span<const double> a)
+{
+    const size_t n = a.size();
+    std::vector<double> zi(n - 1);
+    if (n == 1) {
+        return zi;
+    }
+    double sum_a = 0.0, sum_b = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        sum_a += a[k];
+        sum_b += k == 0 ? 0.0 : b[k] - a[k] * b[0];
+    }
+    zi[0] = sum_b / sum_a;
+    double asum = 1.0, csum = 0.0;
+    for (size_t k = 1; k + 1 < n; ++k) {
+        asum += a[k];
+        csum += b[k] - a[k] * b[0];
+        zi[k] = asum * zi[0] - csum;
+    }
+    return zi;
+}
+
+// Forward-backward filtering of the `n` samples `x(i)` into `y(i)` using `ext` (of size n + 2 * nfact) for the
+// extended signal.
+template<class X, class Y>
+void filtfilt_core(
+  IirFilter<double>& f,
+  std::span<const double> zi,
+  std::span<double> zi_scaled,
+  const X& x,
+  const Y& y,
+  size_t n,
+  std::span<double> ext
+)
+{
+    const size_t nfact = (ext.size() - n) / 2;
+    // Odd reflection at both ends: 2 * x[0] - x[nfact..1], x, 2 * x[n-1] - x[n-2..n-1-nfact].
+    for (size_t i = 0; i < nfact; ++i) {
+        ext[i] = 2 * x(0) - x(nfact - i);
+        ext[nfact + n + i] = 2 * x(n - 1) - x(n - 2 - i);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        ext[nfact + i] = x(i);
+    }
+
+    auto run = [&] {
+        for (size_t i = 0; i < zi.size(); ++i) {
+            zi_scaled[i] = zi[i] * ext[0];
+        }
+        f.set_state(zi_scaled);
+        f.process(ext, ext);
+    };
+    run();
+    ra::reverse(ext);
+    run();
+    for (size_t i = 0; i < n; ++i) {
+        y(i) = ext[ext.size() - 1 - nfact - i];
+    }
+}
 } // namespace
 
-TransferFunctionCoeffs butter(int order, const FilterType::V& filter)
+std::vector<double> filtfilt(std::span<const double> b, std::span<const double> a, std::span<const double> x)
 {
-    assert(order >= 1);
-    return std::visit(
-      [order](auto&& f) -> TransferFunctionCoeffs {
-          using T = std::decay_t<decltype(f)>;
-          if constexpr (std::is_same_v<T, FilterType::LowPass>)
-              return butter_lp(order, f.cutoff);
-          else if constexpr (std::is_same_v<T, FilterType::HighPass>)
-              return butter_hp(order, f.cutoff);
-          else if constexpr (std::is_same_v<T, FilterType::BandPass>)
-              return butter_bp(order, f.low_cutoff, f.high_cutoff);
-          else
-              return butter_bs(order, f.low_cutoff, f.high_cutoff);
+    IirFilter f(b, a);
+    const size_t nfact = 3 * f.order();
+    CHECK(x.size() > nfact);
+    const auto zi = step_steady_state(f.numerator(), f.denominator());
+    std::vector<double> zi_scaled(zi.size()), ext(x.size() + 2 * nfact), y(x.size());
+    filtfilt_core(
+      f,
+      zi,
+      zi_scaled,
+      [x](size_t i) {
+          return x[i];
       },
-      filter
+      [&y](size_t i) -> double& {
+          return y[i];
+      },
+      x.size(),
+      ext
     );
+    return y;
 }
 
-std::complex<double> freqz(std::span<const double> b, std::span<const double> a, double w)
+void filtfilt(
+  std::span<const double> b,
+  std::span<const double> a,
+  std::mdspan<const double, std::dextents<size_t, 2>, std::layout_stride> xs,
+  std::mdspan<double, std::dextents<size_t, 2>, std::layout_stride> ys,
+  size_t n_threads
+)
 {
-    const std::complex<double> z_inv = std::exp(std::complex<double>(0.0, w));
-    return polyval(b, z_inv) / polyval(a, z_inv);
+    CHECK(xs.extent(0) == ys.extent(0) && xs.extent(1) == ys.extent(1));
+    const IirFilter prototype(b, a);
+    const size_t n = xs.extent(0);
+    const size_t nfact = 3 * prototype.order();
+    CHECK(n > nfact);
+    const auto zi = step_steady_state(prototype.numerator(), prototype.denominator());
+
+    parallel_for_chunks(xs.extent(1), n_threads, [&](size_t begin, size_t end) {
+        IirFilter f = prototype;
+        std::vector<double> zi_scaled(zi.size()), ext(n + 2 * nfact);
+        for (size_t c = begin; c < end; ++c) {
+            filtfilt_core(
+              f,
+              zi,
+              zi_scaled,
+              [&xs, c](size_t i) {
+                  return xs[i, c];
+              },
+              [&ys, c](size_t i) -> double& {
+                  return ys[i, c];
+              },
+              n,
+              ext
+            );
+        }
+    });
 }
 
-TransferFunctionCoeffs
-bilinear(std::span<const double> b, std::span<const double> a, double fs, std::optional<double> fp)
+namespace
 {
-    // Prewarping factor λ: s = λ*(z-1)/(z+1).
-    // With fp: match exact frequency response at fp Hz.
-    // Without fp: standard bilinear (λ = 2*fs).
-    const double lam =
-      fp.has_value() ? 2.0 * std::numbers::pi * fp.value() / std::tan(std::numbers::pi * fp.value() / fs) : 2.0 * fs;
-
-    const int nb = static_cast<int>(b.size());
-    const int na = static_cast<int>(a.size());
-    const int n = std::max(nb, na) - 1; // filter order
-
-    // Pad numerator and denominator to the same order n (prepend zeros).
-    std::vector<double> bp(n + 1, 0.0), ap(n + 1, 0.0);
-    std::copy(b.begin(), b.end(), bp.begin() + (n + 1 - nb));
-    std::copy(a.begin(), a.end(), ap.begin() + (n + 1 - na));
-
-    // Precompute (z-1)^k and (z+1)^k for k = 0..n.
-    std::vector<std::vector<double>> zm1(n + 1), zp1(n + 1);
-    zm1[0] = zp1[0] = {1.0};
-    for (int k = 1; k <= n; ++k) {
-        zm1[k] = poly_mul(zm1[k - 1], {1.0, -1.0});
-        zp1[k] = poly_mul(zp1[k - 1], {1.0, 1.0});
-    }
-
-    // Transform P(s) to a z-domain polynomial of degree n:
-    // P_z(z) = sum_{k=0}^{n} p[n-k] * λ^k * (z-1)^k * (z+1)^(n-k)
-    auto transform = [&](const std::vector<double>& p) {
-        std::vector<double> result(n + 1, 0.0);
-        double lam_k = 1.0;
-        for (int k = 0; k <= n; ++k) {
-            const auto term = poly_mul(zm1[k], zp1[n - k]);
-            const double coeff = p[n - k] * lam_k;
-            for (int i = 0; i <= n; ++i) {
-                result[i] += coeff * term[i];
-            }
-            lam_k *= lam;
+// Prewarping factor λ: s = λ*(z-1)/(z+1).
+// With fp: match exact frequency response at fp Hz.
+// Without fp: standard bilinear (λ = 2*fs).
+double bilinear_lambda(double fs, std::optional<double> fp)
+{
+    return fp.has_value() ? 2.0 * std::numbers::pi * fp.value() / std::tan(std::numbers::pi * fp.value() / fs)
+                          : 2.0 * fs;
+}
+} // namespace
+
+namespace detail
+{
+void bilinear_core(
+  std::span<const double> b,
+  std::span<const double> a,
+  double fs,
+  std::optional<double> fp,
+  std::span<double> bz,
+  std::span<double> az,
+  std::span<double> work
+)
+{
+    const size_t n = std::max(b.size(), a.size()) - 1; // filter order
+    CHECK(!a.empty() && bz.size() == n + 1 && az.size() == n + 1 && work.size() >= n + 1);
+
+    const double lam = bilinear_lambda(fs, fp);
+
+    // Transform P(s) = sum(p_j * s^j) to the z-domain polynomial of degree n:
+    //     P_z(z) = (z+1)^n * P(λ*(z-1)/(z+1)) = sum(p_j * λ^j * (z-1)^j * (z+1)^(n-j)),
+    // by Horner's method in (z-1)/(z+1): S_n = p_n, S_m = p_m * (z+1)^(n-m) + λ*(z-1)*S_(m+1), P_z = S_0.
+    // Coefficients in descending powers of z, (z+1)^(n-m) in `work`. O(n^2), in place.
+    const auto transform = [&](std::span<const double> p, std::span<double> result) {
+        // Coefficient of s^j, padded with zeros to degree n.
+        const auto coeff = [p](size_t j) {
+            return j < p.size() ? p[p.size() - 1 - j] : 0.0;
+        };
+        result[0] = coeff(n);
+        work[0] = 1.0;
+        for (size_t len = 1; len <= n; ++len) { // `len` is the length of S_(m+1) and (z+1)^(n-m-1).
+            const size_t m = n - len;
+            work[len] = work[len - 1];
+            for (size_t i = len - 1; i >= 1; --i)
+                work[i] += work[i - 1];
+            result[len] = -lam * result[len - 1];
+            for (size_t i = len - 1; i >= 1; --i)
+                result[i] = lam * (result[i] - result[i - 1]);
+            result[0] *= lam;
+            const double pm = coeff(m);
+            for (size_t i = 0; i <= len; ++i)
+                result[i] += pm * work[i];
         }
-        return result;
     };
-
-    auto bz = transform(bp);
-    auto az = transform(ap);
+    transform(b, bz);
+    transform(a, az);
 
     // Normalize so that az[0] = 1.
     const double a0 = az[0];
@@ -261,8 +770,722 @@ bilinear(std::span<const double> b, std::span<const double> a, double fs, std::o
     for (auto& c : az) {
         c /= a0;
     }
+}
+} // namespace detail
+
+TransferFunctionCoeffs
+bilinear(std::span<const double> b, std::span<const double> a, double fs, std::optional<double> fp)
+{
+#if MEADOW_HAS_EIGEN == 1
+    return zp2tf(bilinear_zpk(tf2zp(b, a), fs, fp));
+#else
+    const size_t n = std::max(b.size(), a.size()) - 1;
+    std::vector<double> bz(n + 1), az(n + 1), work(n + 1);
+    detail::bilinear_core(b, a, fs, fp, bz, az, work);
+    return {MOVE(bz), MOVE(az)};
+#endif
+}
+
+ZeroPoleGain bilinear_zpk(const ZeroPoleGain& analog, double fs, std::optional<double> fp)
+{
+    const double lam = bilinear_lambda(fs, fp);
+    const size_t n = std::max(analog.z.size(), analog.p.size());
+    ZeroPoleGain digital{
+      .z = std::vector<std::complex<double>>(n, -1.0),
+      .p = std::vector<std::complex<double>>(n, -1.0),
+      .k = 0
+    };
+    // s - r = (λ - r) * (z - (λ + r) / (λ - r)) / (z + 1), the (z + 1) factors of the surplus roots remain.
+    std::complex<double> gain = analog.k;
+    for (size_t i = 0; i < analog.z.size(); ++i) {
+        digital.z[i] = (lam + analog.z[i]) / (lam - analog.z[i]);
+        gain *= lam - analog.z[i];
+    }
+    for (size_t i = 0; i < analog.p.size(); ++i) {
+        digital.p[i] = (lam + analog.p[i]) / (lam - analog.p[i]);
+        gain /= lam - analog.p[i];
+    }
+    digital.k = gain.real();
+    return digital;
+}
+
+namespace
+{
+// Ideal (infinite) low-pass impulse response with cutoff `wc` (normalized to Nyquist) at sample `m`.
+double ideal_lowpass(double wc, double m)
+{
+    return wc * sinc(wc * m);
+}
+} // namespace
+
+std::vector<double> fir1(int n, const FilterType::V& filter, std::span<const double> window)
+{
+    CHECK(n >= 1);
+    const auto n_taps = sucast(n + 1);
+    CHECK(window.empty() || window.size() == n_taps);
+
+    // Ideal response and the frequency (normalized to Nyquist) of unit gain.
+    std::function<double(double)> ideal;
+    double f0 = 0;
+    std::visit(
+      [&](auto&& f) {
+          using T = std::decay_t<decltype(f)>;
+          if constexpr (std::is_same_v<T, FilterType::LowPass>) {
+              ideal = [wc = f.cutoff](double m) {
+                  return ideal_lowpass(wc, m);
+              };
+          } else if constexpr (std::is_same_v<T, FilterType::HighPass>) {
+              CHECK(is_even(n));
+              ideal = [wc = f.cutoff](double m) {
+                  return ideal_lowpass(1, m) - ideal_lowpass(wc, m);
+              };
+              f0 = 1;
+          } else if constexpr (std::is_same_v<T, FilterType::BandPass>) {
+              ideal = [w1 = f.low_cutoff, w2 = f.high_cutoff](double m) {
+                  return ideal_lowpass(w2, m) - ideal_lowpass(w1, m);
+              };
+              f0 = (f.low_cutoff + f.high_cutoff) / 2;
+          } else {
+              CHECK(is_even(n));
+              ideal = [w1 = f.low_cutoff, w2 = f.high_cutoff](double m) {
+                  return ideal_lowpass(1, m) - ideal_lowpass(w2, m) + ideal_lowpass(w1, m);
+              };
+          }
+      },
+      filter
+    );
+
+    const auto w = window.empty() ? cached_window(WindowType::hamming, n + 1) : window;
+    std::vector<double> b(n_taps);
+    const double center = n / 2.0;
+    for (size_t i = 0; i < n_taps; ++i) {
+        b[i] = ideal(ifcast<double>(i) - center) * w[i];
+    }
+
+    // Scale to unit gain at f0: abs(sum(b[i] * exp(-j * pi * f0 * i))).
+    std::complex<double> gain = 0;
+    for (size_t i = 0; i < n_taps; ++i) {
+        gain += b[i] * std::polar(1.0, -std::numbers::pi * f0 * ifcast<double>(i));
+    }
+    const double scale = 1 / std::abs(gain);
+    for (auto& c : b) {
+        c *= scale;
+    }
+    return b;
+}
+
+KaiserOrder kaiserord(std::span<const double> f, std::span<const double> a, std::span<const double> dev, double fs)
+{
+    CHECK(a.size() == 2 || a.size() == 3);
+    CHECK(f.size() == 2 * (a.size() - 1) && dev.size() == a.size());
+
+    // Deviations of the passbands are relative to their amplitude.
+    double delta = INFINITY;
+    for (size_t i = 0; i < a.size(); ++i) {
+        CHECK(a[i] == 0 || a[i] == 1);
+        delta = std::min(delta, dev[i] / (a[i] == 0 ? 1 : a[i]));
+    }
+    // The narrowest transition band, in cycles/sample.
+    double df = INFINITY;
+    for (size_t i = 0; i < f.size(); i += 2) {
+        CHECK(f[i] < f[i + 1]);
+        df = std::min(df, (f[i + 1] - f[i]) / fs);
+    }
+
+    // Kaiser's empirical formulas.
+    const double A = -20 * std::log10(delta);
+    double beta = 0;
+    if (A > 50) {
+        beta = 0.1102 * (A - 8.7);
+    } else if (A >= 21) {
+        beta = 0.5842 * std::pow(A - 21, 0.4) + 0.07886 * (A - 21);
+    }
+    const double dw = 2 * std::numbers::pi * df; // rad/sample
+    int n = A > 21 ? iceil<int>((A - 7.95) / (2.285 * dw)) : iceil<int>(5.79 / dw);
+
+    // Cutoffs at the middle of the transition bands, normalized to Nyquist.
+    const auto cutoff = [&](size_t i) {
+        return (f[2 * i] + f[2 * i + 1]) / fs;
+    };
+    KaiserOrder result{.n = 0, .filter = FilterType::LowPass{}, .beta = beta};
+    if (a.size() == 2) {
+        CHECK(a[0] != a[1]);
+        if (a[0] == 1) {
+            result.filter = FilterType::LowPass{cutoff(0)};
+        } else {
+            result.filter = FilterType::HighPass{cutoff(0)};
+        }
+    } else {
+        CHECK(a[0] == a[2] && a[0] != a[1]);
+        if (a[0] == 0) {
+            result.filter = FilterType::BandPass{cutoff(0), cutoff(1)};
+        } else {
+            result.filter = FilterType::BandStop{cutoff(0), cutoff(1)};
+        }
+    }
+    // Filters passing the Nyquist frequency need an even order (type I).
+    if (a.back() != 0 && is_odd(n)) {
+        ++n;
+    }
+    result.n = n;
+    return result;
+}
+
+#if MEADOW_HAS_EIGEN == 1
+std::vector<double> firls(int n, std::span<const double> f, std::span<const double> a)
+{
+    CHECK(n >= 1 && f.size() == a.size() && !f.empty() && is_even(f.size()));
+    CHECK(ra::is_sorted(f) && f.front() >= 0 && f.back() <= 1);
+
+    // The amplitude response of the symmetric filter is A(F) = sum(c[k] * cos(2*pi*m_k*F)), F in cycles/sample, with
+    // m_k = k for odd lengths and k + 1/2 for even lengths. The least-squares c solves G * c = r with
+    // G(i, j) = integral(cos(2*pi*m_i*F) * cos(2*pi*m_j*F)) and r(i) = integral(D(F) * cos(2*pi*m_i*F)) over the bands,
+    // D(F) being the desired amplitude. The integrals are in closed form.
+    const auto n_taps = sucast(n + 1);
+    const bool odd_length = is_odd(n_taps);
+    const size_t n_half = n_taps / 2 + (odd_length ? 1 : 0); // Number of distinct coefficients.
+    const auto m = [odd_length](size_t k) {
+        return ifcast<double>(k) + (odd_length ? 0.0 : 0.5);
+    };
+    // integral(cos(2*pi*q*F)) from 0 to F.
+    const auto cos_integral = [](double q, double F) {
+        return F * sinc(2 * q * F);
+    };
+
+    const auto N = iicast<Eigen::Index>(n_half);
+    Eigen::MatrixXd G = Eigen::MatrixXd::Zero(N, N);
+    Eigen::VectorXd r = Eigen::VectorXd::Zero(N);
+    for (size_t s = 0; s < f.size(); s += 2) {
+        const double F1 = f[s] / 2, F2 = f[s + 1] / 2;
+        if (F1 == F2) {
+            continue;
+        }
+        const double slope = (a[s + 1] - a[s]) / (F2 - F1);
+        const double b1 = a[s] - slope * F1;
+        for (Eigen::Index i = 0; i < N; ++i) {
+            const double mi = m(sucast(i));
+            for (Eigen::Index j = 0; j < N; ++j) {
+                const double p = mi + m(sucast(j)), q = mi - m(sucast(j));
+                G(i, j) += (cos_integral(p, F2) - cos_integral(p, F1) + cos_integral(q, F2) - cos_integral(q, F1)) / 2;
+            }
+            // integral((slope * F + b1) * cos(2*pi*mi*F)), by parts.
+            if (mi == 0) {
+                r(i) += b1 * (F2 - F1) + slope / 2 * (F2 * F2 - F1 * F1);
+            } else {
+                const double two_pi_m = 2 * std::numbers::pi * mi;
+                r(i) += slope / square(two_pi_m) * (std::cos(two_pi_m * F2) - std::cos(two_pi_m * F1))
+                      + (slope * F2 + b1) * cos_integral(mi, F2) - (slope * F1 + b1) * cos_integral(mi, F1);
+            }
+        }
+    }
+    const Eigen::VectorXd c = G.ldlt().solve(r);
+
+    std::vector<double> h(n_taps);
+    const size_t mid = n_taps / 2;
+    if (odd_length) {
+        h[mid] = c(0);
+        for (size_t k = 1; k < n_half; ++k) {
+            h[mid - k] = h[mid + k] = c(iicast<Eigen::Index>(k)) / 2;
+        }
+    } else {
+        for (size_t k = 0; k < n_half; ++k) {
+            h[mid - 1 - k] = h[mid + k] = c(iicast<Eigen::Index>(k)) / 2;
+        }
+    }
+    return h;
+}
+#endif
+
+namespace
+{
+constexpr size_t k_dot_product_lanes = 8;
+
+// Sum of a[j] * b[j] for j < n. Floating-point addition is not associative, so a single running sum doesn't vectorize:
+// the products are summed in independent lanes, which do, then the lanes are added.
+double dot_product(const double* a, const double* b, size_t n)
+{
+    constexpr size_t L = k_dot_product_lanes;
+    const size_t n_full = n - n % L;
+    std::array<double, L> lanes{};
+    for (size_t j = 0; j < n_full; j += L) {
+        for (size_t l = 0; l < L; ++l) {
+            lanes[l] += a[j + l] * b[j + l];
+        }
+    }
+    double acc = 0;
+    for (size_t j = n_full; j < n; ++j) {
+        acc += a[j] * b[j];
+    }
+    for (auto x : lanes) {
+        acc += x;
+    }
+    return acc;
+}
+} // namespace
+
+FirFilter::FirFilter(std::span<const double> b, Method method)
+    : b_reversed(b.rbegin(), b.rend())
+{
+    CHECK(!b.empty());
+    const bool automatic = method == Method::automatic;
+    if (automatic) {
+        method = b.size() >= k_min_fft_taps ? Method::fft : Method::direct;
+    }
+    const size_t history = b.size() - 1;
+    if (method == Method::fft) {
+        // Each FFT of size nfft yields nfft - history outputs, at least 3/4 of nfft.
+        const size_t nfft = std::bit_ceil(4 * b.size());
+        block_size = nfft - history;
+        if (automatic) {
+            // A forward and an inverse real FFT cost about 2 * nfft * log2(nfft) multiply-adds, against size(b) per
+            // output sample in direct form.
+            const auto log2_nfft = iicast<size_t>(std::countr_zero(nfft));
+            min_fft_block = std::min(block_size, 2 * nfft * log2_nfft / b.size());
+        }
+        plan = RealFftPlan::get(nfft);
+        segment.resize(nfft);
+        spectrum.resize(nfft / 2 + 1);
+        b_ft.resize(nfft / 2 + 1);
+        ra::copy(b, segment.begin());
+        plan->forward(segment, b_ft);
+    } else {
+        block_size = 256;
+    }
+    line.assign(history + block_size, 0.0);
+}
+
+void FirFilter::process(std::span<const double> x, std::span<double> y)
+{
+    CHECK(x.size() == y.size());
+    for (size_t i = 0; i < x.size(); i += block_size) {
+        const size_t m = std::min(block_size, x.size() - i);
+        process_block(x.subspan(i, m), y.subspan(i, m));
+    }
+}
+
+void FirFilter::process_block(std::span<const double> x, std::span<double> y)
+{
+    const size_t history = b_reversed.size() - 1;
+    const size_t m = x.size();
+    ra::copy(x, line.begin() + uscast(history));
+    if (plan && m >= min_fft_block) {
+        // Overlap-save: the first `history` outputs of the circular convolution are wrapped around, the next `m` are
+        // the valid outputs.
+        ra::copy(line.begin(), line.begin() + uscast(history + m), segment.begin());
+        std::fill(segment.begin() + uscast(history + m), segment.end(), 0.0);
+        plan->forward(segment, spectrum);
+        for (size_t k = 0; k < spectrum.size(); ++k) {
+            spectrum[k] *= b_ft[k];
+        }
+        plan->inverse(spectrum, segment);
+        ra::copy(segment.begin() + uscast(history), segment.begin() + uscast(history + m), y.begin());
+    } else {
+        for (size_t i = 0; i < m; ++i) {
+            y[i] = dot_product(line.data() + i, b_reversed.data(), b_reversed.size());
+        }
+    }
+    // Keep the last `history` inputs.
+    std::copy(line.begin() + uscast(m), line.begin() + uscast(m + history), line.begin());
+}
+
+double FirFilter::operator()(double x)
+{
+    const size_t history = b_reversed.size() - 1;
+    line[history] = x;
+    const double acc = dot_product(line.data(), b_reversed.data(), b_reversed.size());
+    std::copy(line.begin() + 1, line.begin() + uscast(history + 1), line.begin());
+    return acc;
+}
+
+void FirFilter::reset()
+{
+    ra::fill(line, 0.0);
+}
+
+bool FirFilter::uses_fft() const
+{
+    return plan != nullptr;
+}
+
+StreamingUpfirdn::StreamingUpfirdn(std::span<const double> h, int p_arg, int q_arg)
+    : p(sucast(p_arg))
+    , q(sucast(q_arg))
+    , n_phase_taps((h.size() + p - 1) / p)
+{
+    CHECK(!h.empty() && p_arg >= 1 && q_arg >= 1);
+    // Output y[m] = sum(h[r + j*p] * x[i - j]) where m*q = i*p + r, so phase r convolves the original samples with
+    // every p-th tap. Reversed, so that the dot product runs forward on `line`.
+    phases.assign(p * n_phase_taps, 0.0);
+    for (size_t k = 0; k < h.size(); ++k) {
+        const size_t r = k % p, j = k / p;
+        phases[r * n_phase_taps + n_phase_taps - 1 - j] = h[k];
+    }
+    line.assign(n_phase_taps - 1 + k_block_size, 0.0);
+}
+
+size_t StreamingUpfirdn::max_output_size(size_t n) const
+{
+    return (n * p + q - 1) / q;
+}
+
+size_t StreamingUpfirdn::process(std::span<const double> x, std::span<double> y)
+{
+    CHECK(y.size() >= max_output_size(x.size()));
+    const size_t history = n_phase_taps - 1;
+    size_t n_out = 0;
+    for (size_t begin = 0; begin < x.size(); begin += k_block_size) {
+        const size_t c = std::min(k_block_size, x.size() - begin);
+        ra::copy(x.subspan(begin, c), line.begin() + uscast(history));
+        for (; t < c * p; t += q) {
+            const size_t i = t / p, r = t % p;
+            // Phase r, against x[i - history .. i].
+            y[n_out++] = dot_product(phases.data() + r * n_phase_taps, line.data() + i, n_phase_taps);
+        }
+        t -= c * p;
+        std::copy(line.begin() + uscast(c), line.begin() + uscast(c + history), line.begin());
+    }
+    return n_out;
+}
+
+void StreamingUpfirdn::reset()
+{
+    ra::fill(line, 0.0);
+    t = 0;
+}
+
+std::vector<double> upfirdn(std::span<const double> x, std::span<const double> h, int p, int q)
+{
+    CHECK(!h.empty() && p >= 1 && q >= 1);
+    if (x.empty()) {
+        return {};
+    }
+    const auto P = sucast(p), Q = sucast(q);
+    const size_t n_out = ((x.size() - 1) * P + h.size() + Q - 1) / Q;
+    // Append zeros to flush the filter: output m needs the inputs up to floor(m * q / p).
+    const size_t n_in = std::max(x.size(), (n_out - 1) * Q / P + 1);
+    std::vector<double> padded(n_in, 0.0);
+    ra::copy(x, padded.begin());
+
+    StreamingUpfirdn f(h, p, q);
+    std::vector<double> y(f.max_output_size(n_in));
+    y.resize(f.process(padded, y));
+    CHECK(y.size() >= n_out);
+    y.resize(n_out);
+    return y;
+}
+
+namespace detail
+{
+struct ResampleFilter {
+    size_t p, q; // Coprime.
+    std::vector<double> h;
+    size_t delay; // Samples of `upfirdn`'s output to drop.
+};
+} // namespace detail
+
+namespace
+{
+using detail::ResampleFilter;
+
+// The filter of MATLAB's `resample`, for coprime p and q.
+std::shared_ptr<const ResampleFilter> get_resample_filter(std::pair<size_t, size_t> coprime_pq)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<size_t, size_t>, std::shared_ptr<const ResampleFilter>> cache;
+    std::lock_guard lock(mutex);
+    auto& entry = cache[coprime_pq];
+    if (!entry) {
+        const auto [p, q] = coprime_pq;
+        constexpr size_t N = 10;
+        constexpr double beta = 5;
+        const size_t pq_max = std::max(p, q);
+        const size_t half = N * pq_max; // (L - 1) / 2
+        const size_t L = 2 * half + 1;
+        // Delay the filter so that the center lands on an output sample: MATLAB prepends q - mod(half, q) zeros.
+        const size_t n_zeros = q - half % q;
+        auto result = std::make_shared<ResampleFilter>();
+        result->p = p;
+        result->q = q;
+        result->h.assign(n_zeros + L, 0.0);
+        const auto window = cached_window(WindowType::kaiser, iicast<int>(L), beta);
+        const double wc = 1.0 / ifcast<double>(pq_max);
+        double sum = 0;
+        for (size_t k = 0; k < L; ++k) {
+            const double m = ifcast<double>(k) - ifcast<double>(half);
+            result->h[n_zeros + k] = ideal_lowpass(wc, m) * window[k];
+            sum += result->h[n_zeros + k];
+        }
+        // Like MATLAB, h = p * h / sum(h), so that a constant signal is resampled to the same constant.
+        for (auto& x : result->h) {
+            x *= ifcast<double>(p) / sum;
+        }
+        result->delay = (half + n_zeros) / q;
+        entry = MOVE(result);
+    }
+    return entry;
+}
+
+std::pair<size_t, size_t> reduce_ratio(int p, int q)
+{
+    CHECK(p >= 1 && q >= 1);
+    const int d = std::gcd(p, q);
+    return {sucast(p / d), sucast(q / d)};
+}
+} // namespace
+
+std::vector<double> resample(std::span<const double> x, int p_arg, int q_arg)
+{
+    const auto filter = get_resample_filter(reduce_ratio(p_arg, q_arg));
+    const size_t p = filter->p, q = filter->q;
+    const size_t n_out = (x.size() * p + q - 1) / q;
+    if (n_out == 0) {
+        return {};
+    }
+    // Enough zeros after `x` for delay + n_out outputs.
+    const size_t n_in = std::max(x.size(), ((filter->delay + n_out) * q + p - 1) / p);
+    std::vector<double> padded(n_in, 0.0);
+    ra::copy(x, padded.begin());
+
+    StreamingUpfirdn f(filter->h, iicast<int>(p), iicast<int>(q));
+    std::vector<double> y(f.max_output_size(n_in));
+    const size_t n = f.process(padded, y);
+    CHECK(n >= filter->delay + n_out);
+    y.erase(y.begin(), y.begin() + uscast(filter->delay));
+    y.resize(n_out);
+    return y;
+}
+
+StreamingResampler::StreamingResampler(int p, int q)
+    : StreamingResampler(*get_resample_filter(reduce_ratio(p, q)))
+{
+}
+
+StreamingResampler::StreamingResampler(const detail::ResampleFilter& filter)
+    : polyphase(filter.h, iicast<int>(filter.p), iicast<int>(filter.q))
+    , delay(filter.delay)
+    , to_skip(delay)
+{
+}
 
-    return {bz, az};
+size_t StreamingResampler::max_output_size(size_t n) const
+{
+    return polyphase.max_output_size(n);
+}
+
+size_t StreamingResampler::process(std::span<const double> x, std::span<double> y)
+{
+    const size_t n = polyphase.process(x, y);
+    const size_t skip = std::min(n, to_skip);
+    std::copy(y.begin() + uscast(skip), y.begin() + uscast(n), y.begin());
+    to_skip -= skip;
+    return n - skip;
+}
+
+void StreamingResampler::reset()
+{
+    polyphase.reset();
+    to_skip = delay;
+}
+
+namespace
+{
+void check_segmentation(size_t window_size, size_t noverlap, size_t nfft)
+{
+    CHECK(noverlap < window_size && window_size <= nfft);
+}
+
+size_t segment_count(size_t n, size_t window_size, size_t noverlap)
+{
+    return n < window_size ? 0 : (n - window_size) / (window_size - noverlap) + 1;
+}
+
+// One-sided DFT of the windowed segment `x`, using `buf` (of size nfft, zero after size(x)) for the padded segment.
+void windowed_dft(
+  std::span<const double> x,
+  std::span<const double> window,
+  const RealFftPlan& plan,
+  std::span<double> buf,
+  std::span<std::complex<double>> X
+)
+{
+    for (size_t i = 0; i < x.size(); ++i)
+        buf[i] = x[i] * window[i];
+    plan.forward(buf, X);
+}
+
+// Normalized frequencies of the one-sided DFT bins.
+std::vector<double> one_sided_frequencies(size_t nfft)
+{
+    std::vector<double> w(nfft / 2 + 1);
+    for (size_t k = 0; k < w.size(); ++k)
+        w[k] = 2 * std::numbers::pi * ifcast<double>(k) / ifcast<double>(nfft);
+    return w;
+}
+
+// Turn the sum of `n_segments` periodograms into the one-sided power spectral density.
+PowerSpectralDensity
+make_psd(std::vector<double> sum_periodograms, size_t n_segments, std::span<const double> window, size_t nfft)
+{
+    double u = 0;
+    for (auto w : window)
+        u += w * w;
+    const double scale = 1.0 / (u * 2 * std::numbers::pi * ifcast<double>(n_segments));
+    for (size_t k = 0; k < sum_periodograms.size(); ++k) {
+        // Fold the power of the negative frequencies, all bins except DC and Nyquist have a mirror image.
+        const bool has_mirror = k != 0 && !(is_even(nfft) && k == nfft / 2);
+        sum_periodograms[k] *= has_mirror ? 2 * scale : scale;
+    }
+    return {MOVE(sum_periodograms), one_sided_frequencies(nfft)};
+}
+} // namespace
+
+PowerSpectralDensity pwelch(
+  std::span<const double> x,
+  std::span<const double> window,
+  size_t noverlap,
+  size_t nfft,
+  size_t n_threads
+)
+{
+    check_segmentation(window.size(), noverlap, nfft);
+    const size_t L = window.size(), hop = L - noverlap, n_freqs = nfft / 2 + 1;
+    const size_t n_segments = segment_count(x.size(), L, noverlap);
+    CHECK(n_segments > 0);
+    const auto plan = RealFftPlan::get(nfft);
+
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // One partial sum per part of the segments, added in order, so that the result doesn't depend on the scheduling.
+    const size_t n_parts = std::min(n_threads, n_segments);
+    std::vector<std::vector<double>> partials(n_parts);
+    parallel_for_chunks(n_parts, n_threads, [&](size_t begin, size_t end) {
+        std::vector<double> buf(nfft, 0.0);
+        std::vector<std::complex<double>> X(n_freqs);
+        for (size_t p = begin; p < end; ++p) {
+            auto& partial = partials[p];
+            partial.assign(n_freqs, 0.0);
+            for (size_t j = n_segments * p / n_parts; j < n_segments * (p + 1) / n_parts; ++j) {
+                windowed_dft(x.subspan(j * hop, L), window, *plan, buf, X);
+                for (size_t k = 0; k < n_freqs; ++k)
+                    partial[k] += std::norm(X[k]);
+            }
+        }
+    });
+    std::vector<double> sum_periodograms = MOVE(partials[0]);
+    for (size_t p = 1; p < n_parts; ++p) {
+        for (size_t k = 0; k < n_freqs; ++k)
+            sum_periodograms[k] += partials[p][k];
+    }
+    return make_psd(MOVE(sum_periodograms), n_segments, window, nfft);
+}
+
+std::span<const std::complex<double>> Spectrogram::column(size_t j) const
+{
+    CHECK(j < n_segments);
+    return std::span(s).subspan(j * n_freqs, n_freqs);
+}
+
+Spectrogram spectrogram(
+  std::span<const double> x,
+  std::span<const double> window,
+  size_t noverlap,
+  size_t nfft,
+  size_t n_threads
+)
+{
+    check_segmentation(window.size(), noverlap, nfft);
+    const size_t L = window.size(), hop = L - noverlap, n_freqs = nfft / 2 + 1;
+    const size_t n_segments = segment_count(x.size(), L, noverlap);
+    CHECK(n_segments > 0);
+    const auto plan = RealFftPlan::get(nfft);
+
+    Spectrogram r{
+      std::vector<std::complex<double>>(n_freqs * n_segments),
+      n_freqs,
+      n_segments,
+      one_sided_frequencies(nfft),
+      std::vector<double>(n_segments)
+    };
+    for (size_t j = 0; j < n_segments; ++j)
+        r.t[j] = ifcast<double>(j * hop) + ifcast<double>(L - 1) / 2;
+    parallel_for_chunks(n_segments, n_threads, [&](size_t begin, size_t end) {
+        std::vector<double> buf(nfft, 0.0);
+        for (size_t j = begin; j < end; ++j) {
+            windowed_dft(x.subspan(j * hop, L), window, *plan, buf, std::span(r.s).subspan(j * n_freqs, n_freqs));
+        }
+    });
+    return r;
+}
+
+StreamingStft::StreamingStft(std::span<const double> window_arg, size_t noverlap, size_t nfft)
+    : window(window_arg.begin(), window_arg.end())
+    , hop(window_arg.size() - noverlap)
+    , plan(RealFftPlan::get(nfft))
+    , pending(window_arg.size())
+    , segment(nfft, 0.0)
+    , spectrum(nfft / 2 + 1)
+{
+    check_segmentation(window_arg.size(), noverlap, nfft);
+}
+
+void StreamingStft::push(
+  std::span<const double> x,
+  const std::function<void(std::span<const std::complex<double>> column)>& on_column
+)
+{
+    const size_t L = window.size();
+    while (!x.empty()) {
+        const size_t n = std::min(L - n_pending, x.size());
+        ra::copy(x.first(n), pending.begin() + uscast(n_pending));
+        n_pending += n;
+        x = x.subspan(n);
+        if (n_pending == L) {
+            windowed_dft(pending, window, *plan, segment, spectrum);
+            on_column(spectrum);
+            // Keep the overlapping part for the next segment.
+            std::copy(pending.begin() + uscast(hop), pending.end(), pending.begin());
+            n_pending = L - hop;
+        }
+    }
+}
+
+void StreamingStft::reset()
+{
+    n_pending = 0;
+}
+
+size_t StreamingStft::n_freqs() const
+{
+    return spectrum.size();
+}
+
+StreamingWelch::StreamingWelch(std::span<const double> window_arg, size_t noverlap, size_t nfft_arg)
+    : stft(window_arg, noverlap, nfft_arg)
+    , window(window_arg.begin(), window_arg.end())
+    , nfft(nfft_arg)
+    , sum_periodograms(stft.n_freqs(), 0.0)
+{
+}
+
+void StreamingWelch::push(std::span<const double> x)
+{
+    stft.push(x, [this](std::span<const std::complex<double>> column) {
+        for (size_t k = 0; k < column.size(); ++k)
+            sum_periodograms[k] += std::norm(column[k]);
+        ++num_segments;
+    });
+}
+
+size_t StreamingWelch::n_segments() const
+{
+    return num_segments;
+}
+
+PowerSpectralDensity StreamingWelch::psd() const
+{
+    CHECK(num_segments > 0);
+    return make_psd(sum_periodograms, num_segments, window, nfft);
 }
 
 } // namespace matlab
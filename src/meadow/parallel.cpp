@@ -0,0 +1,31 @@
+#include "meadow/parallel.h"
+
+#include "meadow/cppext.h"
+
+void parallel_for_chunks(size_t n, size_t n_threads, const std::function<void(size_t begin, size_t end)>& fn)
+{
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    n_threads = std::min(n_threads, n);
+    if (n_threads <= 1) {
+        if (n > 0) {
+            fn(0, n);
+        }
+        return;
+    }
+    // The first `n % n_threads` chunks are one element larger.
+    const size_t chunk = n / n_threads;
+    const size_t remainder = n % n_threads;
+    auto chunk_begin = [&](size_t i) {
+        return i * chunk + std::min(i, remainder);
+    };
+    vector<std::jthread> threads;
+    threads.reserve(n_threads - 1);
+    for (size_t i = 1; i < n_threads; ++i) {
+        threads.emplace_back([&fn, b = chunk_begin(i), e = chunk_begin(i + 1)] {
+            fn(b, e);
+        });
+    }
+    fn(0, chunk_begin(1));
+}
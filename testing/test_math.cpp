@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <random>
+
 namespace
 {
 void expectDoubleEq(pair<double, double> a, pair<double, double> b)
@@ -361,6 +364,235 @@ TEST(math, RunningStat_large_offset)
     EXPECT_DOUBLE_EQ(rs.var(VarianceNorm::population), 22.5);
 }
 
+TEST(math, RunningStat_merge_and_bulk_add)
+{
+    std::vector<double> xs(5000);
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = 1e6 + 100 * std::sin(0.37 * static_cast<double>(i)) + static_cast<double>(i % 13);
+    // Reference from the exact differences x - 1e6.
+    const double n = static_cast<double>(xs.size());
+    double mean = 0, var = 0;
+    for (auto x : xs)
+        mean += x - 1e6;
+    mean /= n;
+    for (auto x : xs)
+        var += square(x - 1e6 - mean);
+    var /= n - 1;
+    mean += 1e6;
+    const auto expect_same = [&](const RunningStat& rs, const char* what) {
+        SCOPED_TRACE(what);
+        EXPECT_EQ(rs.count(), xs.size());
+        EXPECT_NEAR(rs.mean(), mean, 1e-14 * mean);
+        EXPECT_NEAR(rs.var(), var, 1e-12 * var);
+        EXPECT_EQ(rs.min(), *ra::min_element(xs));
+        EXPECT_EQ(rs.max(), *ra::max_element(xs));
+    };
+
+    // Merging two halves, and into or from an empty one.
+    RunningStat a, b;
+    for (size_t i = 0; i < xs.size(); ++i)
+        (i < 1234 ? a : b)(xs[i]);
+    RunningStat merged;
+    merged.merge(a);
+    merged.merge(b);
+    merged.merge(RunningStat());
+    expect_same(merged, "merge");
+
+    RunningStat bulk;
+    bulk.add(std::span(xs).first(3));
+    bulk.add(std::span(xs).subspan(3));
+    expect_same(bulk, "add");
+
+    for (size_t n_threads : std::array<size_t, 3>{1, 3, 8})
+        expect_same(parallel_running_stat(xs, n_threads), "parallel_running_stat");
+    EXPECT_EQ(parallel_running_stat({}, 4).count(), 0u);
+}
+
+TEST(math, RunningMoments)
+{
+    // MATLAB: x = [2 4 4 4 5 5 7 9]; skewness(x), kurtosis(x) - 3
+    RunningMoments rm;
+    for (double x : {2, 4, 4, 4, 5, 5, 7, 9})
+        rm(x);
+    EXPECT_EQ(rm.count(), 8u);
+    EXPECT_DOUBLE_EQ(rm.mean(), 5.0);
+    EXPECT_DOUBLE_EQ(rm.var(VarianceNorm::population), 4.0);
+    EXPECT_DOUBLE_EQ(rm.stddev(), sqrt(32.0 / 7));
+    EXPECT_NEAR(rm.skewness(), 0.65625, 1e-14);
+    EXPECT_NEAR(rm.excess_kurtosis(), 2.78125 - 3, 1e-14);
+
+    // Merging parts of a skewed sample with an offset gives the moments of the whole.
+    std::vector<double> xs(3000);
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = 1e3 + std::exp(std::sin(0.1 * static_cast<double>(i)));
+    RunningMoments all, a, b, c;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        all(xs[i]);
+        (i < 100 ? a : i < 2500 ? b : c)(xs[i]);
+    }
+    b.merge(c);
+    a.merge(b);
+    a.merge(RunningMoments());
+    EXPECT_EQ(a.count(), all.count());
+    EXPECT_NEAR(a.mean(), all.mean(), 1e-12);
+    EXPECT_NEAR(a.var(), all.var(), 1e-12);
+    EXPECT_NEAR(a.skewness(), all.skewness(), 1e-10);
+    EXPECT_NEAR(a.excess_kurtosis(), all.excess_kurtosis(), 1e-10);
+
+    rm.reset();
+    EXPECT_EQ(rm.count(), 0u);
+    rm(1.0);
+    rm(1.0);
+    EXPECT_TRUE(std::isnan(rm.skewness()));
+}
+
+namespace
+{
+// Uniform samples in [0, 1), the same on every platform.
+std::vector<double> uniform_samples(size_t n)
+{
+    std::mt19937 gen(42);
+    std::vector<double> xs(n);
+    for (auto& x : xs)
+        x = static_cast<double>(gen()) / 4294967296.0;
+    return xs;
+}
+} // namespace
+
+TEST(math, P2Quantiles)
+{
+    const std::array<double, 3> ps = {0.5, 0.95, 0.99};
+    P2Quantiles q(ps);
+    EXPECT_EQ(q.num_quantiles(), 3u);
+    // Exact while there are fewer samples than markers, MATLAB: quantile([4 1 3 2], [0.5 0.95 0.99])
+    for (double x : {4, 1, 3, 2})
+        q(x);
+    EXPECT_DOUBLE_EQ(q.quantile(0), 2.5);
+    EXPECT_DOUBLE_EQ(q.quantile(1), 4.0);
+    EXPECT_DOUBLE_EQ(q.quantile(2), 4.0);
+
+    q.reset();
+    const auto xs = uniform_samples(100000);
+    q.add(xs);
+    EXPECT_EQ(q.count(), xs.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+        EXPECT_NEAR(q.quantile(i), ps[i], 0.005);
+}
+
+TEST(math, TDigest)
+{
+    // Exact for a few samples, MATLAB: quantile([5 3 9 1 7], [0 0.05 0.25 0.5 0.8 1])
+    TDigest small;
+    for (double x : {5, 3, 9, 1, 7})
+        small(x);
+    EXPECT_DOUBLE_EQ(small.quantile(0), 1.0);
+    EXPECT_DOUBLE_EQ(small.quantile(0.05), 1.0);
+    EXPECT_DOUBLE_EQ(small.quantile(0.25), 2.5);
+    EXPECT_DOUBLE_EQ(small.quantile(0.5), 5.0);
+    EXPECT_DOUBLE_EQ(small.quantile(0.8), 8.0);
+    EXPECT_DOUBLE_EQ(small.quantile(1), 9.0);
+
+    // Merged digests of parts of the stream estimate the quantiles of the whole, the tails more precisely.
+    const auto xs = uniform_samples(100000);
+    std::span<const double> xs_span(xs);
+    TDigest all;
+    all.add(xs_span.first(30000));
+    for (double x : xs_span.subspan(30000, 30000))
+        all(x);
+    TDigest part;
+    part.add(xs_span.subspan(60000));
+    all.merge(part);
+    // Queried through a const reference, the buffered samples are merged on read.
+    const TDigest& merged = all;
+    EXPECT_EQ(merged.count(), xs.size());
+    EXPECT_LE(merged.num_centroids(), 100u);
+    EXPECT_DOUBLE_EQ(all.min(), *std::ranges::min_element(xs));
+    EXPECT_DOUBLE_EQ(all.max(), *std::ranges::max_element(xs));
+    auto sorted = xs;
+    std::ranges::sort(sorted);
+    for (auto [p, tolerance] : {std::pair{0.5, 2e-3}, {0.95, 1e-3}, {0.99, 1e-3}, {0.999, 3e-4}}) {
+        SCOPED_TRACE(p);
+        EXPECT_NEAR(merged.quantile(p), sorted[static_cast<size_t>(p * 100000)], tolerance);
+    }
+
+    all.reset();
+    EXPECT_EQ(all.count(), 0u);
+}
+
+TEST(math, EwmStat)
+{
+    // Half-life 1: weights 1/4, 1/4, 1/2 after three samples.
+    EwmStat e(1);
+    EXPECT_DOUBLE_EQ(e.alpha(), 0.5);
+    e.add(std::array<double, 3>{1, 2, 3});
+    EXPECT_EQ(e.count(), 3u);
+    EXPECT_DOUBLE_EQ(e.mean(), 2.25);
+    EXPECT_DOUBLE_EQ(e.var(VarianceNorm::population), 0.6875);
+    EXPECT_DOUBLE_EQ(e.var(), 0.6875 / (1 - 0.375));
+    EXPECT_DOUBLE_EQ(e.stddev(), sqrt(1.1));
+
+    // Two samples of any weight have the sample variance of `var`.
+    e.reset();
+    e(1);
+    e(2);
+    EXPECT_DOUBLE_EQ(e.var(), 0.5);
+
+    // Against explicitly weighted sums.
+    const double halflife = 7.5;
+    const double alpha = 1 - std::exp2(-1 / halflife);
+    std::vector<double> xs(200), ys(200);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = 100 + std::sin(0.3 * static_cast<double>(i));
+        ys[i] = std::cos(0.2 * static_cast<double>(i)) - 0.5 * xs[i];
+    }
+    std::vector<double> ws(xs.size());
+    for (size_t i = 0; i < ws.size(); ++i)
+        ws[i] = (i == 0 ? 1 : alpha) * std::pow(1 - alpha, static_cast<double>(ws.size() - 1 - i));
+    double mx = 0, my = 0, sum_w2 = 0;
+    for (size_t i = 0; i < ws.size(); ++i) {
+        mx += ws[i] * xs[i];
+        my += ws[i] * ys[i];
+        sum_w2 += ws[i] * ws[i];
+    }
+    double vx = 0, vy = 0, cxy = 0;
+    for (size_t i = 0; i < ws.size(); ++i) {
+        vx += ws[i] * square(xs[i] - mx);
+        vy += ws[i] * square(ys[i] - my);
+        cxy += ws[i] * (xs[i] - mx) * (ys[i] - my);
+    }
+    EwmCov c(halflife);
+    c.add(xs, ys);
+    EXPECT_NEAR(c.mean_x(), mx, 1e-12);
+    EXPECT_NEAR(c.mean_y(), my, 1e-12);
+    EXPECT_NEAR(c.var_x(VarianceNorm::population), vx, 1e-12);
+    EXPECT_NEAR(c.var_y(), vy / (1 - sum_w2), 1e-12);
+    EXPECT_NEAR(c.cov(), cxy / (1 - sum_w2), 1e-12);
+    EXPECT_NEAR(c.corr(), cxy / sqrt(vx * vy), 1e-12);
+
+    // Each series of MultiEwmStat is the EwmStat of that series.
+    MultiEwmStat m(2, halflife);
+    std::vector<double> ticks;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        ticks.push_back(xs[i]);
+        ticks.push_back(ys[i]);
+    }
+    m(std::span(ticks).first(2));
+    m.add(std::span(ticks).subspan(2));
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_EQ(m.count(), xs.size());
+    EwmStat ex(halflife), ey(halflife);
+    ex.add(xs);
+    ey.add(ys);
+    EXPECT_DOUBLE_EQ(m.mean(0), ex.mean());
+    EXPECT_DOUBLE_EQ(m.means()[1], ey.mean());
+    EXPECT_DOUBLE_EQ(m.var(0), ex.var());
+    EXPECT_DOUBLE_EQ(m.stddev(1, VarianceNorm::population), ey.stddev(VarianceNorm::population));
+    EXPECT_DOUBLE_EQ(ex.var(), c.var_x());
+
+    m.reset();
+    EXPECT_EQ(m.count(), 0u);
+}
+
 TEST(math, RunningStat_reset)
 {
     auto rs = makeRunningStat({1.0, 2.0});
@@ -285,6 +285,79 @@ TEST(matlab, hann_poisson_fn)
     );
 }
 
+TEST(matlab, window_vectors)
+{
+    const double eps = 1e-15;
+    for (int L : {2, 7, 8}) {
+        const auto N = sucast(L);
+        expect_near(
+          matlab::blackman(L),
+          make_win(N, [L](int n) {
+              return matlab::blackman_fn(n, L);
+          }),
+          eps
+        );
+#if MEADOW_HAS_CYL_BESSEL_I == 1 || MEADOW_HAS_BOOST == 1
+        expect_near(
+          matlab::kaiser(L, 1.78),
+          make_win(N, [L](int n) {
+              return matlab::kaiser_fn(n, L, 1.78);
+          }),
+          eps
+        );
+#endif
+    }
+    expect_near(matlab::hann(5), vector<double>({0, 0.5, 1, 0.5, 0}), eps);
+    expect_near(matlab::hamming(5), vector<double>({0.08, 0.54, 1, 0.54, 0.08}), eps);
+    expect_near(
+      matlab::flattopwin(5),
+      vector<double>({-0.000421051, -0.05473684, 1.000000003, -0.05473684, -0.000421051}),
+      1e-14
+    );
+    expect_near(matlab::tukeywin(9, 0.5), vector<double>({0, 0.5, 1, 1, 1, 1, 1, 0.5, 0}), eps);
+    expect_near(matlab::tukeywin(4, 0), vector<double>({1, 1, 1, 1}), eps);
+    expect_near(matlab::tukeywin(5, 1), matlab::hann(5), eps);
+    EXPECT_EQ(matlab::hann(1), vector<double>({1.0}));
+    EXPECT_EQ(matlab::blackman(1), vector<double>({1.0}));
+    EXPECT_TRUE(matlab::hann(0).empty());
+}
+
+TEST(matlab, kaiser)
+{
+    // MATLAB: kaiser(7, 1.23)
+    expect_near(
+      matlab::kaiser(7, 1.23),
+      vector<double>(
+        {0.706450386180156,
+         0.862875634246974,
+         0.964683201523233,
+         1.000000000000000,
+         0.964683201523233,
+         0.862875634246974,
+         0.706450386180156}
+      ),
+      1e-15
+    );
+    EXPECT_EQ(matlab::kaiser(1, 5.0), vector<double>({1.0}));
+    EXPECT_EQ(matlab::kaiser(5, 0.0), vector<double>(5, 1.0));
+    // Large beta: the first sample is 1 / I0(beta).
+    EXPECT_NEAR(matlab::kaiser(8, 40.0)[0] * 1.48947747934199e16, 1.0, 1e-13);
+}
+
+TEST(matlab, cached_window)
+{
+    const auto w = matlab::cached_window(matlab::WindowType::hann, 64);
+    EXPECT_EQ(vector<double>(w.begin(), w.end()), matlab::hann(64));
+    EXPECT_EQ(matlab::cached_window(matlab::WindowType::hann, 64).data(), w.data());
+    // The parameter is ignored for windows without one.
+    EXPECT_EQ(matlab::cached_window(matlab::WindowType::hann, 64, 3.0).data(), w.data());
+
+    const auto g1 = matlab::cached_window(matlab::WindowType::gausswin, 16, 2.5);
+    const auto g2 = matlab::cached_window(matlab::WindowType::gausswin, 16, 3.0);
+    EXPECT_NE(g1.data(), g2.data());
+    EXPECT_EQ(vector<double>(g2.begin(), g2.end()), matlab::gausswin(16, 3.0));
+}
+
 TEST(matlab, nextpow2_int8_t)
 {
     const int8_t expected[] = {7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
@@ -342,6 +415,45 @@ TEST(matlab, polyfit1)
     EXPECT_DOUBLE_EQ(r[1], 1.0);
 }
 
+TEST(matlab, sliding_polyfit1)
+{
+    // Timestamps with a large offset, a trend changing over time and some noise.
+    constexpr size_t n = 1000, window = 37;
+    vector<double> xs(n), ys(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double t = ifcast<double>(i);
+        xs[i] = 1e6 + 0.5 * t;
+        ys[i] = 3 + 0.01 * t * std::sin(0.01 * t) + 0.1 * std::sin(1.7 * t);
+    }
+
+    const auto r = matlab::sliding_polyfit1<double>(xs, ys, window);
+    ASSERT_EQ(r.size(), n - window + 1);
+    for (size_t k = 0; k < r.size(); ++k) {
+        // Reference: polyfit1 in coordinates relative to the window, shifted back.
+        vector<double> us(window);
+        for (size_t i = 0; i < window; ++i)
+            us[i] = xs[k + i] - xs[k];
+        const auto p = matlab::polyfit1<double>(us, span<const double>(ys).subspan(k, window));
+        EXPECT_NEAR(r[k][0], p[0], 1e-12);
+        EXPECT_NEAR(r[k][1], p[1] - p[0] * xs[k], 1e-6);
+    }
+
+    // Streaming, while the window fills up.
+    matlab::SlidingPolyfit1<double> fitter(window);
+    fitter.push(1, 3);
+    EXPECT_EQ(fitter.size(), 1u);
+    fitter.push(2, 5);
+    fitter.push(3, 7);
+    EXPECT_FALSE(fitter.full());
+    const auto p = fitter.fit();
+    EXPECT_NEAR(p[0], 2.0, 1e-14);
+    EXPECT_NEAR(p[1], 1.0, 1e-14);
+    fitter.reset();
+    EXPECT_EQ(fitter.size(), 0u);
+
+    EXPECT_TRUE(matlab::sliding_polyfit1<double>(span(xs).first(5), span(ys).first(5), 6).empty());
+}
+
 TEST(matlab, polyval)
 {
     array<double, 4> cs{2, 3, 4, 5};
@@ -353,6 +465,42 @@ TEST(matlab, polyval)
     ASSERT_EQ(matlab::polyval(span<const double>(cs.data(), 4), x), 866.0);
 }
 
+TEST(matlab, polyval_batch)
+{
+    // Sizes around the group of x values evaluated together, degrees on both sides of the Estrin threshold.
+    vector<double> xs(21);
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = -1.3 + 0.13 * ifcast<double>(i);
+    for (size_t n_cs : array<size_t, 9>{0, 1, 2, 3, 4, 5, 9, 10, 17}) {
+        vector<double> cs(n_cs);
+        for (size_t k = 0; k < n_cs; ++k)
+            cs[k] = 1.0 / ifcast<double>(k + 1) - 0.3;
+        for (size_t n : array<size_t, 4>{0, 7, 8, 21}) {
+            const auto x = span<const double>(xs).first(n);
+            vector<double> horner(n), estrin(n), automatic(n);
+            matlab::detail::polyval_horner<double, double>(cs, x, horner);
+            matlab::detail::polyval_estrin<double, double>(cs, x, estrin);
+            matlab::polyval<double, double>(cs, x, automatic);
+            for (size_t i = 0; i < n; ++i) {
+                const double expected = matlab::polyval(span<const double>(cs), x[i]);
+                const double eps = 1e-14 * std::max(1.0, std::abs(expected)); // Estrin rounds differently.
+                EXPECT_EQ(horner[i], expected);
+                EXPECT_NEAR(estrin[i], expected, eps);
+                EXPECT_NEAR(automatic[i], expected, eps);
+            }
+        }
+    }
+
+    // Real coefficients at complex points.
+    const double cs[] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    vector<std::complex<double>> zs(10), out(zs.size());
+    for (size_t i = 0; i < zs.size(); ++i)
+        zs[i] = std::polar(0.9, 0.3 * ifcast<double>(i));
+    matlab::polyval<double, std::complex<double>>(cs, zs, out);
+    for (size_t i = 0; i < zs.size(); ++i)
+        EXPECT_NEAR(std::abs(out[i] - matlab::polyval(span<const double>(cs), zs[i])), 0, 1e-13);
+}
+
 TEST(matlab, polyder)
 {
     array<double, 4> cs{2, 3, 4, 5};
@@ -377,6 +525,47 @@ TEST(matlab, polyder_noalloc)
     );
 }
 
+#if MEADOW_HAS_EIGEN == 1
+TEST(matlab, roots)
+{
+    const auto sorted_by_real = [](std::vector<std::complex<double>> r) {
+        ra::sort(r, [](auto a, auto b) {
+            return a.real() < b.real() || (a.real() == b.real() && a.imag() < b.imag());
+        });
+        return r;
+    };
+    {
+        // MATLAB: roots([1 -6 11 -6])
+        const auto r = sorted_by_real(matlab::roots(vector<double>({1, -6, 11, -6})));
+        ASSERT_EQ(r.size(), 3u);
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_NEAR(r[i].real(), ifcast<double>(i + 1), 1e-12);
+            EXPECT_NEAR(r[i].imag(), 0, 1e-12);
+        }
+    }
+    {
+        // Leading zeros are ignored, trailing zeros are roots at 0: roots([0 2 0 2 0 0]) = [i; -i; 0; 0]
+        const auto r = matlab::roots(vector<double>({0, 2, 0, 2, 0, 0}));
+        ASSERT_EQ(r.size(), 4u);
+        EXPECT_EQ(r[2], 0.0);
+        EXPECT_EQ(r[3], 0.0);
+        const auto s = sorted_by_real(vector<std::complex<double>>(r.begin(), r.begin() + 2));
+        EXPECT_NEAR(std::abs(s[0] - std::complex<double>(0, -1)), 0, 1e-14);
+        EXPECT_NEAR(std::abs(s[1] - std::complex<double>(0, 1)), 0, 1e-14);
+    }
+    {
+        // Roots of very different magnitudes, where balancing the companion matrix matters.
+        const double r_expected[] = {1e-4, 1, 1e4};
+        const auto r = sorted_by_real(matlab::roots(vector<double>({1, -10001.0001, 10001.0001, -1})));
+        ASSERT_EQ(r.size(), 3u);
+        for (size_t i = 0; i < 3; ++i)
+            EXPECT_NEAR(r[i].real(), r_expected[i], 1e-12 * r_expected[i]);
+    }
+    EXPECT_TRUE(matlab::roots(vector<double>({5})).empty());
+    EXPECT_TRUE(matlab::roots(vector<double>({0, 0})).empty());
+}
+#endif
+
 TEST(matlab, roots2)
 {
     {
@@ -401,6 +590,53 @@ TEST(matlab, roots2)
     NOP;
 }
 
+TEST(matlab, real_roots_batch)
+{
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    const auto expect_roots = [](span<const double> actual, vector<double> expected, double eps) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            if (std::isnan(expected[i])) {
+                EXPECT_TRUE(std::isnan(actual[i])) << i;
+            } else {
+                EXPECT_NEAR(actual[i], expected[i], eps * std::max(1.0, std::abs(expected[i]))) << i;
+            }
+        }
+    };
+    {
+        // 3(x + 7)(x - 5), x^2 + 1, (x - 2)^2, 1e-8 x^2 + x - 1 (the small root needs the stable formula).
+        const double cs[] = {3, 6, -105, 1, 0, 1, 1, -4, 4, 1e-8, 1, -1};
+        double r[8];
+        matlab::real_roots2<double>(cs, r);
+        expect_roots(r, {-7, 5, nan, nan, 2, 2, -100000000.99999999, 0.99999999}, 1e-14);
+    }
+    {
+        // 2(x - 1)(x - 2)(x + 3), (x - 1)(x^2 + 1), x^3, (x - 10)(x - 10.001)(x + 1e3)
+        const double cs[] = {2, 0, -14, 12, 1, -1, 1, -1, 1, 0, 0, 0, 1, 979.999, -19900.99, 100010};
+        double r[12];
+        matlab::real_roots3<double>(cs, r);
+        expect_roots(r, {-3, 1, 2, 1, nan, nan, 0, 0, 0, -1e3, 10, 10.001}, 1e-9);
+    }
+    {
+        // (x - 1)(x - 2)(x - 3)(x - 4), (x^2 + 1)(x^2 - 4), (x^2 + 1)(x^2 + 4), 2(x + 1)(x - 1)(x - 0.5)(x + 5)
+        const double cs[] = {1, -10, 35, -50, 24, 1, 0, -3, 0, -4, 1, 0, 5, 0, 4, 2, 9, -7, -9, 5};
+        double r[12];
+        matlab::real_roots4<double>(span(cs).first(15), r);
+        expect_roots(r, {1, 2, 3, 4, -2, 2, nan, nan, nan, nan, nan, nan}, 1e-12);
+        double r2[4];
+        matlab::real_roots4<double>(span(cs).subspan(15), r2);
+        expect_roots(r2, {-5, -1, 0.5, 1}, 1e-12);
+    }
+    {
+        // Float, against the double results.
+        const float cs[] = {1, -10, 35, -50, 24};
+        float r[4];
+        matlab::real_roots4<float>(cs, r);
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_NEAR(r[i], ifcast<float>(i + 1), 1e-4f);
+    }
+}
+
 TEST(matlab, polyfit)
 {
     constexpr double eps = 1e-12;
@@ -444,6 +680,45 @@ TEST(matlab, polyfit)
     }
 }
 
+TEST(matlab, poly_fitter)
+{
+    constexpr size_t n = 40, n_series = 7;
+    vector<double> xs(n);
+    for (size_t i = 0; i < n; ++i)
+        xs[i] = 0.25 * ifcast<double>(i) - 3;
+    // Interleaved: ys[i, j] = data[i * n_series + j].
+    vector<double> data(n * n_series);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n_series; ++j)
+            data[i * n_series + j] = std::sin(ifcast<double>(j + 1) * xs[i]) + ifcast<double>(j) * xs[i];
+
+    using Extents = std::dextents<size_t, 2>;
+    const std::layout_stride::mapping<Extents> interleaved(
+      Extents(n, n_series), std::array<size_t, 2>{n_series, 1}
+    );
+    const std::mdspan<const double, Extents, std::layout_stride> ys(data.data(), interleaved);
+    for (int degree : {0, 1, 3, 5}) {
+        const matlab::PolyFitter fitter(mdspan_using_data_and_size(xs), degree);
+        EXPECT_EQ(fitter.degree(), degree);
+        EXPECT_EQ(fitter.size(), n);
+        const auto cs = fitter.fit(ys, 3);
+        ASSERT_EQ(cs.size(), n_series * sucast(degree + 1));
+        for (size_t j = 0; j < n_series; ++j) {
+            vector<double> y(n);
+            for (size_t i = 0; i < n; ++i)
+                y[i] = ys[i, j];
+            const auto expected =
+              matlab::polyfit(mdspan_using_data_and_size(xs), mdspan_using_data_and_size(y), degree);
+            const auto row = vector<double>(
+              cs.begin() + iicast<ptrdiff_t>(j) * (degree + 1), cs.begin() + iicast<ptrdiff_t>(j + 1) * (degree + 1)
+            );
+            expect_near(row, expected, 1e-12);
+            // A single series with a stride.
+            expect_near(fitter.fit(mdspan_from_data_size_stride(data.data() + j, n, n_series)), expected, 1e-12);
+        }
+    }
+}
+
 TEST(matlab, sinc)
 {
     // Expected values for x = 10^i, i in [-10, -1] (sinc well away from zero)
@@ -592,6 +867,51 @@ TEST(matlab, cov)
     }
 }
 
+TEST(matlab, describe)
+{
+    const auto xs = vector<double>({1, 3, 1, 4, 1, 5});
+    const auto ys = vector<double>({2, 5, 8, 5, 8, 4});
+    for (int w : {0, 1}) {
+        const auto d = matlab::describe(xs, ys, w);
+        const auto c = matlab::cov(xs, ys, w);
+        EXPECT_DOUBLE_EQ(d.mean_x, matlab::mean(xs));
+        EXPECT_DOUBLE_EQ(d.mean_y, matlab::mean(ys));
+        EXPECT_DOUBLE_EQ(d.var_x, c[0][0]);
+        EXPECT_DOUBLE_EQ(d.var_y, c[1][1]);
+        EXPECT_DOUBLE_EQ(d.cov, c[0][1]);
+        EXPECT_DOUBLE_EQ(d.corr, matlab::corr(xs, ys));
+    }
+
+    // Several chunks, with a large offset that a single-pass sum of squares would cancel.
+    vector<double> xl(5000), yl(5000);
+    for (size_t i = 0; i < xl.size(); ++i) {
+        xl[i] = 1e9 + std::sin(0.01 * ifcast<double>(i));
+        yl[i] = -1e9 + std::sin(0.01 * ifcast<double>(i) + 0.5);
+    }
+    const auto d = matlab::describe(xl, yl, 1);
+    double mx = 0, my = 0;
+    for (size_t i = 0; i < xl.size(); ++i) {
+        mx += xl[i] - 1e9;
+        my += yl[i] + 1e9;
+    }
+    mx /= ifcast<double>(xl.size());
+    my /= ifcast<double>(xl.size());
+    double sxx = 0, syy = 0, sxy = 0;
+    for (size_t i = 0; i < xl.size(); ++i) {
+        sxx += square(xl[i] - 1e9 - mx);
+        syy += square(yl[i] + 1e9 - my);
+        sxy += (xl[i] - 1e9 - mx) * (yl[i] + 1e9 - my);
+    }
+    const double n = ifcast<double>(xl.size());
+    EXPECT_NEAR(d.mean_x, 1e9 + mx, 1e-6);
+    EXPECT_NEAR(d.mean_y, -1e9 + my, 1e-6);
+    EXPECT_NEAR(d.var_x, sxx / n, 1e-8);
+    EXPECT_NEAR(d.var_y, syy / n, 1e-8);
+    EXPECT_NEAR(d.cov, sxy / n, 1e-8);
+    EXPECT_NEAR(d.corr, sxy / std::sqrt(sxx * syy), 1e-8);
+    EXPECT_NEAR(matlab::var(xl, 1), d.var_x, 1e-15);
+}
+
 TEST(matlab, cov2)
 {
     const auto xs = {1.0, 3.0, 1.0, 4.0, 1.0, 5.0};
@@ -634,3 +954,88 @@ TEST(matlab, std)
     EXPECT_DOUBLE_EQ(matlab::std(xs, 1), 1.6072751268321592);
     EXPECT_DOUBLE_EQ(matlab::std(xs), sqrt(matlab::var(xs)));
 }
+
+TEST(matlab, movstat)
+{
+    // MATLAB: A = [4 8 6 -1 -2 -3 -1 3 4 5]; movmean(A, 3), movmedian(A, 3), movmin(A, [2 0])
+    const std::vector<double> as = {4, 8, 6, -1, -2, -3, -1, 3, 4, 5};
+    const auto means = matlab::movmean(as, 3);
+    const std::vector<double> expected_means = {6, 6, 13.0 / 3, 1, -2, -2, -1.0 / 3, 2, 4, 4.5};
+    for (size_t i = 0; i < as.size(); ++i)
+        EXPECT_NEAR(means[i], expected_means[i], 1e-14);
+    EXPECT_EQ(matlab::movmedian(as, 3), (std::vector<double>{6, 6, 6, -1, -2, -2, -1, 3, 4, 4.5}));
+    EXPECT_EQ(matlab::movmin(as, {2, 0}), (std::vector<double>{4, 4, 4, -1, -2, -3, -3, -3, -1, 3}));
+    // A window longer than the input covers all of it, without storage for the whole window.
+    for (const double m : matlab::movmean(as, 1'000'000'000))
+        EXPECT_NEAR(m, 2.3, 1e-14);
+    EXPECT_EQ(matlab::movmedian(as, 1'000'000'000), std::vector<double>(as.size(), 3.5));
+
+    // Against the statistics of each truncated window, with an offset that would cancel in a naive variance.
+    std::vector<double> xs(300);
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = 1e6 + std::sin(0.7 * static_cast<double>(i)) + 0.25 * static_cast<double>(i % 7);
+    for (const matlab::MovWindow window :
+         {matlab::MovWindow(1), matlab::MovWindow(4), matlab::MovWindow(7), matlab::MovWindow(0, 5),
+          matlab::MovWindow(3, 0), matlab::MovWindow(400, 400)}) {
+        SCOPED_TRACE(std::format("before = {}, after = {}", window.before, window.after));
+        const auto sums = matlab::movsum(xs, window);
+        const auto mean = matlab::movmean(xs, window);
+        const auto mins = matlab::movmin(xs, window);
+        const auto maxs = matlab::movmax(xs, window);
+        const auto medians = matlab::movmedian(xs, window);
+        const auto vars = matlab::movvar(xs, window);
+        const auto stds = matlab::movstd(xs, window, 1);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            const size_t begin = i - std::min(i, window.before);
+            const size_t end = std::min(xs.size(), i + window.after + 1);
+            const std::span<const double> w(xs.data() + begin, end - begin);
+            auto sorted = std::vector<double>(w.begin(), w.end());
+            std::ranges::sort(sorted);
+            const size_t n = sorted.size();
+            EXPECT_NEAR(sums[i], matlab::mean(w) * static_cast<double>(n), 1e-9 * static_cast<double>(n));
+            EXPECT_NEAR(mean[i], matlab::mean(w), 1e-9);
+            EXPECT_EQ(mins[i], sorted.front());
+            EXPECT_EQ(maxs[i], sorted.back());
+            EXPECT_DOUBLE_EQ(medians[i], n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+            EXPECT_NEAR(vars[i], n == 1 ? 0 : matlab::var(w), 1e-9);
+            EXPECT_NEAR(stds[i], matlab::std(w, 1), 1e-9);
+        }
+    }
+}
+
+TEST(matlab, MovingStat)
+{
+    matlab::MovingStat ms(3);
+    matlab::MovingMedian mm(3);
+    const std::vector<double> xs = {5, 1, 4, 4, 9, -2, 0};
+    for (size_t i = 0; i < xs.size(); ++i) {
+        ms.push(xs[i]);
+        mm.push(xs[i]);
+        const size_t begin = i < 2 ? 0 : i - 2;
+        std::vector<double> w(xs.begin() + static_cast<ptrdiff_t>(begin), xs.begin() + static_cast<ptrdiff_t>(i + 1));
+        EXPECT_EQ(ms.size(), w.size());
+        EXPECT_EQ(ms.full(), w.size() == 3);
+        EXPECT_DOUBLE_EQ(ms.sum(), std::accumulate(w.begin(), w.end(), 0.0));
+        EXPECT_DOUBLE_EQ(ms.mean(), matlab::mean(w));
+        EXPECT_EQ(ms.min(), *std::ranges::min_element(w));
+        EXPECT_EQ(ms.max(), *std::ranges::max_element(w));
+        if (w.size() > 1) {
+            EXPECT_NEAR(ms.var(), matlab::var(w), 1e-12);
+        }
+        std::ranges::sort(w);
+        EXPECT_DOUBLE_EQ(mm.median(), w.size() == 2 ? (w[0] + w[1]) / 2 : w[w.size() / 2]);
+    }
+    ms.pop();
+    mm.pop();
+    EXPECT_DOUBLE_EQ(ms.mean(), -1.0);
+    EXPECT_DOUBLE_EQ(mm.median(), -1.0);
+    EXPECT_DOUBLE_EQ(ms.var(), 2.0);
+
+    ms.reset();
+    mm.reset();
+    EXPECT_EQ(ms.size(), 0u);
+    EXPECT_EQ(mm.size(), 0u);
+    ms.push(7);
+    EXPECT_DOUBLE_EQ(ms.var(), 0.0);
+    EXPECT_DOUBLE_EQ(ms.mean(), 7.0);
+}
@@ -0,0 +1,107 @@
+#include "meadow/matlab_fft.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+namespace
+{
+
+std::vector<std::complex<double>> naive_dft(std::span<const std::complex<double>> x)
+{
+    const size_t n = x.size();
+    std::vector<std::complex<double>> X(n);
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            const auto angle = -2.0 * std::numbers::pi * static_cast<double>((j * k) % n) / static_cast<double>(n);
+            X[k] += x[j] * std::polar(1.0, angle);
+        }
+    }
+    return X;
+}
+
+std::vector<std::complex<double>> test_signal(size_t n)
+{
+    std::vector<std::complex<double>> x(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto t = static_cast<double>(i);
+        x[i] = {std::sin(0.3 * t) + 0.1 * t, std::cos(1.7 * t) - 0.5};
+    }
+    return x;
+}
+
+void expect_near(std::span<const std::complex<double>> x, std::span<const std::complex<double>> y, double e)
+{
+    ASSERT_EQ(x.size(), y.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_NEAR(x[i].real(), y[i].real(), e) << "index " << i << " of " << x.size();
+        EXPECT_NEAR(x[i].imag(), y[i].imag(), e) << "index " << i << " of " << x.size();
+    }
+}
+
+} // namespace
+
+TEST(matlab_fft, fft_small)
+{
+    // MATLAB: fft([1 2 3 4])
+    const std::complex<double> x[] = {1, 2, 3, 4};
+    const std::complex<double> expected[] = {
+      {10, 0 },
+      {-2, 2 },
+      {-2, 0 },
+      {-2, -2}
+    };
+    expect_near(matlab::fft(x), expected, 1e-15);
+}
+
+TEST(matlab_fft, fft_matches_dft)
+{
+    std::vector<size_t> sizes;
+    for (size_t n = 1; n <= 40; ++n)
+        sizes.push_back(n);
+    for (size_t n : {64u, 100u, 127u, 256u, 1000u, 1024u})
+        sizes.push_back(n);
+    for (size_t n : sizes) {
+        const auto x = test_signal(n);
+        const auto expected = naive_dft(x);
+        expect_near(matlab::fft(x), expected, 1e-9 * static_cast<double>(n));
+        expect_near(matlab::ifft(expected), x, 1e-12 * static_cast<double>(n));
+    }
+}
+
+TEST(matlab_fft, fft_pad_and_truncate)
+{
+    const std::complex<double> x[] = {1, 2, 3};
+    const std::complex<double> padded[] = {1, 2, 3, 0, 0};
+    expect_near(matlab::fft(x, 5), naive_dft(padded), 1e-14);
+    expect_near(matlab::fft(x, 2), naive_dft(std::span(x).first(2)), 1e-14);
+}
+
+TEST(matlab_fft, real_fft)
+{
+    for (size_t n : {1u, 2u, 3u, 4u, 5u, 6u, 8u, 10u, 15u, 16u, 33u, 64u, 90u, 512u}) {
+        std::vector<double> x(n);
+        std::vector<std::complex<double>> xc(n);
+        for (size_t i = 0; i < n; ++i)
+            xc[i] = x[i] = std::sin(0.7 * static_cast<double>(i)) + static_cast<double>(i % 3);
+        const auto expected = naive_dft(xc);
+
+        expect_near(matlab::fft(x), expected, 1e-10 * static_cast<double>(n));
+        const auto X = matlab::rfft(x);
+        expect_near(X, std::span(expected).first(n / 2 + 1), 1e-10 * static_cast<double>(n));
+
+        const auto y = matlab::irfft(X, n);
+        ASSERT_EQ(y.size(), n);
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_NEAR(y[i], x[i], 1e-12 * static_cast<double>(n));
+    }
+}
+
+TEST(matlab_fft, plans_are_cached)
+{
+    EXPECT_EQ(matlab::FftPlan::get(48), matlab::FftPlan::get(48));
+    EXPECT_EQ(matlab::RealFftPlan::get(48), matlab::RealFftPlan::get(48));
+    EXPECT_EQ(matlab::FftPlan::get(48)->size(), 48u);
+}
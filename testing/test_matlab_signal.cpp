@@ -1,10 +1,12 @@
 #include "matlab_butter_test_data.h"
+#include "meadow/matlab.h"
 #include "meadow/matlab_signal.h"
 
 #include <gtest/gtest.h>
 
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <numbers>
 
 namespace
@@ -357,3 +359,848 @@ TEST(matlab_signal, bilinear_order2_prewarp)
     expect_near(r.b, {2.67223550176609592199e-07, 5.34447100131174579474e-07, 2.67223550287631894662e-07}, eps);
     expect_near(r.a, {1.00000000000000000000e+00, -1.99853734787105885573e+00, 9.98538416765259451147e-01}, eps);
 }
+
+// ---- Second-order sections -----------------------------------------------
+
+namespace
+{
+// Evaluate g * prod(H_i(z)).
+std::complex<double> eval_sos(const matlab::SecondOrderSections& s, std::complex<double> z)
+{
+    std::complex<double> h = s.g;
+    for (auto& c : s.sos)
+        h *= (c[0] * z * z + c[1] * z + c[2]) / (c[3] * z * z + c[4] * z + c[5]);
+    return h;
+}
+
+// Reference direct-form filter, y[n] = sum(b[k] x[n-k]) - sum(a[k] y[n-k]), a[0] = 1.
+std::vector<double> direct_form(const matlab::TransferFunctionCoeffs& tf, const std::vector<double>& x)
+{
+    std::vector<double> y(x.size());
+    for (size_t n = 0; n < x.size(); ++n) {
+        double acc = 0;
+        for (size_t k = 0; k < tf.b.size() && k <= n; ++k)
+            acc += tf.b[k] * x[n - k];
+        for (size_t k = 1; k < tf.a.size() && k <= n; ++k)
+            acc -= tf.a[k] * y[n - k];
+        y[n] = acc;
+    }
+    return y;
+}
+} // namespace
+
+TEST(matlab_signal, zp2sos_butter_lp_order2)
+{
+    // MATLAB: [z,p,k] = butter(2, 0.5); [sos,g] = zp2sos(z,p,k)
+    // sos = [1 2 1 1 0 3-2√2], g = 1-1/√2
+    const double s2 = std::numbers::sqrt2;
+    auto s = matlab::butter_sos(2, matlab::FilterType::LowPass{0.5});
+    ASSERT_EQ(s.sos.size(), 1u);
+    expect_near({s.sos[0].begin(), s.sos[0].end()}, {1.0, 2.0, 1.0, 1.0, 0.0, 3.0 - 2.0 * s2}, 1e-14);
+    EXPECT_NEAR(s.g, 1.0 - 1.0 / s2, 1e-14);
+}
+
+TEST(matlab_signal, butter_sos_matches_butter)
+{
+    const matlab::FilterType::V filters[] = {
+      matlab::FilterType::LowPass{0.3},
+      matlab::FilterType::HighPass{0.3},
+      matlab::FilterType::BandPass{0.2, 0.6},
+      matlab::FilterType::BandStop{0.2, 0.6},
+    };
+    for (int order : {1, 2, 3, 4, 5}) {
+        for (auto& f : filters) {
+            const auto tf = matlab::butter(order, f);
+            const auto s = matlab::butter_sos(order, f);
+            EXPECT_EQ(s.sos.size(), tf.a.size() / 2);
+            for (double w : {0.0, 0.5, 1.0, 2.0, 3.0}) {
+                const auto z = std::exp(std::complex<double>(0.0, w));
+                const auto h_tf = eval_h(tf, z);
+                const auto h_sos = eval_sos(s, z);
+                EXPECT_NEAR(std::abs(h_tf - h_sos), 0.0, 1e-9) << "order " << order << " w " << w;
+            }
+        }
+    }
+}
+
+TEST(matlab_signal, zp2sos_poles_closest_to_unit_circle_last)
+{
+    auto s = matlab::butter_sos(4, matlab::FilterType::BandPass{0.1, 0.15});
+    ASSERT_EQ(s.sos.size(), 4u);
+    double prev_radius = 0;
+    for (auto& c : s.sos) {
+        const double radius = std::sqrt(std::abs(c[5])); // |p|^2 = a2 for a conjugate pair.
+        EXPECT_GE(radius, prev_radius - 1e-12);
+        prev_radius = radius;
+    }
+}
+
+TEST(matlab_signal, sos_filter_matches_direct_form)
+{
+    std::vector<double> x(200);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = std::sin(0.1 * static_cast<double>(i)) + (i % 7 == 0 ? 1.0 : 0.0);
+
+    for (int order : {1, 2, 3}) {
+        const matlab::FilterType::V f = matlab::FilterType::BandPass{0.2, 0.4};
+        const auto expected = direct_form(matlab::butter(order, f), x);
+
+        // Process in blocks of varying size to exercise the state handling.
+        matlab::SosFilter filter(matlab::butter_sos(order, f));
+        std::vector<double> y(x.size());
+        size_t i = 0;
+        for (size_t block = 1; i < x.size(); ++block) {
+            const size_t n = std::min(block, x.size() - i);
+            filter.process(std::span(x).subspan(i, n), std::span(y).subspan(i, n));
+            i += n;
+        }
+        expect_near(y, expected, 1e-10);
+
+        filter.reset();
+        for (size_t j = 0; j < x.size(); ++j)
+            EXPECT_NEAR(filter(x[j]), expected[j], 1e-10);
+    }
+}
+
+TEST(matlab_signal, sos_filter_high_order_narrow_band_is_stable)
+{
+    // 16th-order band-pass with a narrow band: the direct form is numerically unstable, the cascade is not.
+    matlab::SosFilter filter(matlab::butter_sos(8, matlab::FilterType::BandPass{0.1, 0.11}));
+    std::vector<double> x(20000, 0.0);
+    x[0] = 1.0;
+    filter.process(x, x);
+    double tail = 0;
+    for (size_t i = x.size() - 1000; i < x.size(); ++i)
+        tail = std::max(tail, std::abs(x[i]));
+    EXPECT_LT(tail, 1e-6);
+}
+
+TEST(matlab_signal, float_filters_match_double)
+{
+    const matlab::FilterType::V f = matlab::FilterType::LowPass{0.2};
+    std::vector<double> x(500);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = std::sin(0.05 * static_cast<double>(i)) + (i % 11 == 0 ? 0.5 : 0.0);
+    const std::vector<float> xf(x.begin(), x.end());
+
+    const auto expected = matlab::filter(matlab::butter(4, f).b, matlab::butter(4, f).a, x).y;
+    std::vector<float> y(x.size());
+
+    matlab::SosFilter<float> sos(matlab::butter_sos(4, f));
+    sos.process(xf, y);
+    for (size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(y[i], expected[i], 1e-5);
+
+    matlab::IirFilter<float> iir(matlab::butter(4, f));
+    iir.process(xf, y);
+    for (size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(y[i], expected[i], 1e-4);
+
+    constexpr auto k_butter4 = matlab::butter<4>(matlab::FilterType::LowPass{0.2});
+    matlab::StaticIirFilter<5, float> static_iir(k_butter4);
+    static_iir.process(xf, y);
+    for (size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(y[i], expected[i], 1e-4);
+
+    // 16 float lanes, 20 channels of the same signal.
+    constexpr size_t n_channels = 20;
+    std::vector<float> xs(x.size() * n_channels), ys(xs.size());
+    for (size_t i = 0; i < xs.size(); ++i)
+        xs[i] = xf[i / n_channels];
+    using Extents = std::dextents<size_t, 2>;
+    const std::layout_stride::mapping<Extents> mapping(
+      Extents(x.size(), n_channels), std::array<size_t, 2>{n_channels, 1}
+    );
+    matlab::IirFilterBank<float> bank(matlab::butter(4, f), n_channels);
+    bank.process(
+      std::mdspan<const float, Extents, std::layout_stride>(xs.data(), mapping),
+      std::mdspan<float, Extents, std::layout_stride>(ys.data(), mapping)
+    );
+    for (size_t i = 0; i < ys.size(); ++i)
+        EXPECT_EQ(ys[i], y[i / n_channels]);
+}
+
+TEST(matlab_signal, fixed_point_adapters)
+{
+    const int16_t x16[] = {-32768, -16384, 0, 1, 32767};
+    float f[5];
+    matlab::fixed_to_float(std::span<const int16_t>(x16), std::span<float>(f));
+    EXPECT_EQ(f[0], -1.0f);
+    EXPECT_EQ(f[1], -0.5f);
+    EXPECT_EQ(f[3], 1.0f / 32768);
+
+    // Round trip is exact, values beyond [-1, 1) saturate.
+    int16_t y16[5];
+    matlab::float_to_fixed(std::span<const float>(f), std::span<int16_t>(y16));
+    EXPECT_TRUE(ra::equal(x16, y16));
+    const double big[] = {1.5, -2.0, 0.9999999999, 0.25}; // The third one rounds to 2^31.
+    int32_t y32[4];
+    matlab::float_to_fixed(std::span<const double>(big), std::span<int32_t>(y32));
+    EXPECT_EQ(y32[0], std::numeric_limits<int32_t>::max());
+    EXPECT_EQ(y32[1], std::numeric_limits<int32_t>::min());
+    EXPECT_EQ(y32[2], std::numeric_limits<int32_t>::max());
+    EXPECT_EQ(y32[3], 1 << 29);
+
+    // Filtering fixed-point samples in place, longer than the internal block.
+    std::vector<int16_t> samples(1000);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = static_cast<int16_t>(std::lround(20000 * std::sin(0.03 * static_cast<double>(i))));
+    std::vector<double> expected(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+        expected[i] = samples[i] / 32768.0;
+    matlab::SosFilter<double> reference(matlab::butter_sos(2, matlab::FilterType::LowPass{0.1}));
+    reference.process(expected, expected);
+
+    matlab::SosFilter<float> filter(matlab::butter_sos(2, matlab::FilterType::LowPass{0.1}));
+    matlab::process_fixed(filter, std::span<const int16_t>(samples), std::span<int16_t>(samples));
+    for (size_t i = 0; i < samples.size(); ++i)
+        EXPECT_NEAR(samples[i], expected[i] * 32768, 1.0);
+}
+
+// ---- filter ------------------------------------------------------------
+
+TEST(matlab_signal, filter_first_order)
+{
+    // MATLAB: [y, zf] = filter(1, [1 -0.5], [1 1 1])
+    const double b[] = {1.0};
+    const double a[] = {1.0, -0.5};
+    const double x[] = {1.0, 1.0, 1.0};
+    auto r = matlab::filter(b, a, x);
+    expect_near(r.y, {1.0, 1.5, 1.75}, 1e-15);
+    expect_near(r.zf, {0.875}, 1e-15);
+
+    // Same filter with a[0] != 1.
+    const double b2[] = {2.0};
+    const double a2[] = {2.0, -1.0};
+    auto r2 = matlab::filter(b2, a2, x);
+    expect_near(r2.y, r.y, 1e-15);
+    expect_near(r2.zf, r.zf, 1e-15);
+}
+
+TEST(matlab_signal, filter_fir)
+{
+    // MATLAB: [y, zf] = filter([1 2 3], 1, [1 0 0 1])
+    const double b[] = {1.0, 2.0, 3.0};
+    const double a[] = {1.0};
+    const double x[] = {1.0, 0.0, 0.0, 1.0};
+    auto r = matlab::filter(b, a, x);
+    expect_near(r.y, {1.0, 2.0, 3.0, 1.0}, 1e-15);
+    expect_near(r.zf, {2.0, 3.0}, 1e-15);
+}
+
+TEST(matlab_signal, filter_zi_zf_continuation)
+{
+    const auto tf = matlab::butter(3, matlab::FilterType::LowPass{0.2});
+    std::vector<double> x(100);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = std::cos(0.3 * static_cast<double>(i)) + 0.5;
+
+    const auto full = matlab::filter(tf.b, tf.a, x);
+    expect_near(full.y, direct_form(tf, x), 1e-12);
+
+    const auto first = matlab::filter(tf.b, tf.a, std::span(x).first(37));
+    const auto second = matlab::filter(tf.b, tf.a, std::span(x).subspan(37), first.zf);
+    for (size_t i = 0; i < 37; ++i)
+        EXPECT_NEAR(first.y[i], full.y[i], 1e-15);
+    for (size_t i = 37; i < x.size(); ++i)
+        EXPECT_NEAR(second.y[i - 37], full.y[i], 1e-15);
+    expect_near(second.zf, full.zf, 1e-15);
+}
+
+TEST(matlab_signal, iir_filter_blocks)
+{
+    const auto tf = matlab::butter(2, matlab::FilterType::HighPass{0.1});
+    std::vector<double> x(256);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = static_cast<double>(i % 13) - 6.0;
+    const auto expected = matlab::filter(tf.b, tf.a, x);
+
+    matlab::IirFilter f(tf);
+    EXPECT_EQ(f.order(), 2u);
+    std::vector<double> y(x);
+    for (size_t i = 0; i < y.size(); i += 64)
+        f.process(std::span(y).subspan(i, 64), std::span(y).subspan(i, 64));
+    expect_near(y, expected.y, 1e-15);
+    expect_near({f.state().begin(), f.state().end()}, expected.zf, 1e-15);
+
+    f.reset();
+    EXPECT_NEAR(f(x[0]), expected.y[0], 1e-15);
+}
+
+// ---- filtfilt ----------------------------------------------------------
+
+TEST(matlab_signal, filtfilt_preserves_ramp)
+{
+    // The odd reflection of a ramp is a ramp, and the zero-phase moving average leaves it intact.
+    const double b[] = {0.5, 0.5};
+    const double a[] = {1.0};
+    std::vector<double> x(10);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = 1.0 + 2.0 * static_cast<double>(i);
+    expect_near(matlab::filtfilt(b, a, x), x, 1e-14);
+}
+
+TEST(matlab_signal, filtfilt_constant_has_no_transient)
+{
+    const auto tf = matlab::butter(4, matlab::FilterType::LowPass{0.1});
+    const std::vector<double> x(50, 3.0);
+    expect_near(matlab::filtfilt(tf.b, tf.a, x), x, 1e-10);
+}
+
+TEST(matlab_signal, filtfilt_zero_phase)
+{
+    // A sinusoid in the passband comes out with gain |H|^2 and no phase shift.
+    const auto tf = matlab::butter(2, matlab::FilterType::LowPass{0.3});
+    const double w = 0.1 * num::pi;
+    const double gain = std::norm(matlab::freqz(tf.b, tf.a, w));
+    std::vector<double> x(400);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = std::sin(w * static_cast<double>(i));
+    const auto y = matlab::filtfilt(tf.b, tf.a, x);
+    for (size_t i = 100; i < 300; ++i)
+        EXPECT_NEAR(y[i], gain * x[i], 1e-6);
+}
+
+TEST(matlab_signal, filtfilt_batch_matches_single)
+{
+    const auto tf = matlab::butter(3, matlab::FilterType::BandPass{0.1, 0.3});
+    constexpr size_t n = 300, n_channels = 5;
+    // Interleaved samples: xs[i, c] = data[i * n_channels + c].
+    std::vector<double> data(n * n_channels), out(n * n_channels);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t c = 0; c < n_channels; ++c)
+            data[i * n_channels + c] = std::sin(0.05 * static_cast<double>((c + 1) * i)) + static_cast<double>(c);
+
+    using Extents = std::dextents<size_t, 2>;
+    const std::layout_stride::mapping<Extents> mapping(Extents(n, n_channels), std::array<size_t, 2>{n_channels, 1});
+    matlab::filtfilt(
+      tf.b,
+      tf.a,
+      std::mdspan<const double, Extents, std::layout_stride>(data.data(), mapping),
+      std::mdspan<double, Extents, std::layout_stride>(out.data(), mapping),
+      2
+    );
+
+    for (size_t c = 0; c < n_channels; ++c) {
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; ++i)
+            x[i] = data[i * n_channels + c];
+        const auto y = matlab::filtfilt(tf.b, tf.a, x);
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_DOUBLE_EQ(out[i * n_channels + c], y[i]);
+    }
+}
+
+TEST(matlab_signal, iir_filter_bank_matches_single)
+{
+    const auto tf = matlab::butter(3, matlab::FilterType::BandPass{0.1, 0.3});
+    constexpr size_t n = 200, n_channels = 11; // One full and one partial group of lanes.
+    std::vector<double> data(n * n_channels);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = std::sin(0.37 * static_cast<double>(i)) + 0.1 * static_cast<double>(i % 7);
+
+    using Extents = std::dextents<size_t, 2>;
+    using Strides = std::array<size_t, 2>;
+    const Strides interleaved{n_channels, 1}, planar{1, n};
+    for (const auto& strides : {interleaved, planar}) {
+        matlab::IirFilterBank bank(tf, n_channels);
+        EXPECT_EQ(bank.order(), 6u);
+        const auto at = [&strides](size_t i, size_t c) {
+            return i * strides[0] + c * strides[1];
+        };
+        const auto half = [&](double* p, size_t first_row) {
+            const std::layout_stride::mapping<Extents> mapping(Extents(n / 2, n_channels), strides);
+            return std::mdspan<double, Extents, std::layout_stride>(p + at(first_row, 0), mapping);
+        };
+        // Two calls, the second one in place.
+        std::vector<double> out = data;
+        bank.process(half(data.data(), 0), half(out.data(), 0));
+        bank.process(half(out.data(), n / 2), half(out.data(), n / 2));
+
+        for (size_t c = 0; c < n_channels; ++c) {
+            std::vector<double> x(n);
+            for (size_t i = 0; i < n; ++i)
+                x[i] = data[at(i, c)];
+            const auto y = matlab::filter(tf.b, tf.a, x).y;
+            for (size_t i = 0; i < n; ++i)
+                EXPECT_NEAR(out[at(i, c)], y[i], 1e-12);
+        }
+    }
+}
+
+TEST(matlab_signal, freqz_different_sizes)
+{
+    // MATLAB: freqz([1 1], 1, [0 pi/2 pi])
+    const double b[] = {1.0, 1.0};
+    const double a[] = {1.0};
+    assert_near(matlab::freqz(b, a, 0.0), complex<double>(2, 0), 1e-15);
+    assert_near(matlab::freqz(b, a, num::pi / 2), complex<double>(1, -1), 1e-15);
+    assert_near(matlab::freqz(b, a, num::pi), complex<double>(0, 0), 1e-15);
+}
+
+TEST(matlab_signal, freqz_batch)
+{
+    const auto tf = matlab::butter(5, matlab::FilterType::BandPass{0.2, 0.5});
+    std::vector<double> w;
+    for (int i = 0; i < 37; ++i)
+        w.push_back(0.085 * i);
+    const auto r = matlab::freqz(tf.b, tf.a, w);
+    ASSERT_EQ(r.h.size(), w.size());
+    const auto mag = r.magnitude();
+    const auto phase = r.phase();
+    for (size_t i = 0; i < w.size(); ++i) {
+        const auto expected = matlab::freqz(tf.b, tf.a, w[i]);
+        EXPECT_NEAR(std::abs(r.h[i] - expected), 0, 1e-12);
+        EXPECT_NEAR(mag[i], std::abs(expected), 1e-12);
+        EXPECT_NEAR(std::abs(std::polar(1.0, phase[i]) - expected / std::abs(expected)), 0, 1e-9);
+    }
+}
+
+TEST(matlab_signal, freqz_n_points)
+{
+    const auto tf = matlab::butter(3, matlab::FilterType::HighPass{0.4});
+    const auto r = matlab::freqz(tf.b, tf.a, size_t(512));
+    ASSERT_EQ(r.w.size(), 512u);
+    ASSERT_EQ(r.h.size(), 512u);
+    EXPECT_EQ(r.w[0], 0.0);
+    EXPECT_NEAR(r.w[256], num::pi / 2, 1e-15);
+    for (size_t i = 0; i < r.w.size(); i += 7)
+        EXPECT_NEAR(std::abs(r.h[i] - matlab::freqz(tf.b, tf.a, r.w[i])), 0, 1e-12);
+}
+
+// ---- pwelch, spectrogram -------------------------------------------------
+
+namespace
+{
+std::vector<double> noise_like(size_t n)
+{
+    std::vector<double> x(n);
+    uint32_t state = 12345;
+    for (auto& v : x) {
+        state = state * 1664525u + 1013904223u;
+        v = static_cast<double>(state >> 8) / static_cast<double>(1u << 24) - 0.5;
+    }
+    return x;
+}
+} // namespace
+
+TEST(matlab_signal, pwelch_parseval)
+{
+    // Rectangular window, no overlap: the integral of the PSD is the mean power of the signal.
+    const auto x = noise_like(64 * 20);
+    for (size_t nfft : {64u, 65u}) {
+        const std::vector<double> window(64, 1.0);
+        const auto p = matlab::pwelch(x, window, 0, nfft);
+        ASSERT_EQ(p.pxx.size(), nfft / 2 + 1);
+        ASSERT_EQ(p.w.size(), nfft / 2 + 1);
+        double power = 0, mean_square = 0;
+        for (auto v : p.pxx)
+            power += v * 2 * std::numbers::pi / static_cast<double>(nfft);
+        for (auto v : x)
+            mean_square += v * v / static_cast<double>(x.size());
+        EXPECT_NEAR(power, mean_square, 1e-12);
+    }
+}
+
+TEST(matlab_signal, pwelch_sinusoid_peak)
+{
+    std::vector<double> x(4096);
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = std::sin(std::numbers::pi / 4 * static_cast<double>(i));
+    const auto p = matlab::pwelch(x, matlab::blackman(256), 128, 256, 3);
+    const auto peak = std::max_element(p.pxx.begin(), p.pxx.end()) - p.pxx.begin();
+    EXPECT_NEAR(p.w[static_cast<size_t>(peak)], std::numbers::pi / 4, 1e-12);
+
+    // Same result on one thread.
+    const auto p1 = matlab::pwelch(x, matlab::blackman(256), 128, 256, 1);
+    expect_near(p.pxx, p1.pxx, 1e-12);
+
+    // Bit-identical on every run with the same number of threads.
+    for (int run = 0; run < 5; ++run)
+        EXPECT_EQ(matlab::pwelch(x, matlab::blackman(256), 128, 256, 3).pxx, p.pxx);
+}
+
+TEST(matlab_signal, spectrogram_columns)
+{
+    const auto x = noise_like(1000);
+    const auto window = matlab::gausswin(100, 2.5);
+    const size_t noverlap = 60, nfft = 128;
+    const auto s = matlab::spectrogram(x, window, noverlap, nfft, 2);
+    EXPECT_EQ(s.n_freqs, nfft / 2 + 1);
+    EXPECT_EQ(s.n_segments, (x.size() - noverlap) / (window.size() - noverlap));
+    for (size_t j = 0; j < s.n_segments; ++j) {
+        std::vector<double> seg(nfft, 0.0);
+        for (size_t i = 0; i < window.size(); ++i)
+            seg[i] = x[j * 40 + i] * window[i];
+        const auto expected = matlab::rfft(seg);
+        const auto col = s.column(j);
+        for (size_t k = 0; k < s.n_freqs; ++k)
+            EXPECT_NEAR(std::abs(col[k] - expected[k]), 0, 1e-12);
+        EXPECT_DOUBLE_EQ(s.t[j], static_cast<double>(j * 40) + 49.5);
+    }
+}
+
+TEST(matlab_signal, streaming_stft_and_welch)
+{
+    const auto x = noise_like(3000);
+    const auto window = matlab::blackman(128);
+    const auto batch = matlab::spectrogram(x, window, 96, 256);
+    const auto batch_psd = matlab::pwelch(x, window, 96, 256);
+
+    matlab::StreamingStft stft(window, 96, 256);
+    matlab::StreamingWelch welch(window, 96, 256);
+    size_t n_columns = 0;
+    size_t i = 0;
+    for (size_t block = 1; i < x.size(); block = block * 3 % 101 + 1) {
+        const auto chunk = std::span(x).subspan(i, std::min(block, x.size() - i));
+        stft.push(chunk, [&](std::span<const std::complex<double>> column) {
+            ASSERT_LT(n_columns, batch.n_segments);
+            const auto expected = batch.column(n_columns);
+            for (size_t k = 0; k < column.size(); ++k)
+                EXPECT_NEAR(std::abs(column[k] - expected[k]), 0, 1e-12);
+            ++n_columns;
+        });
+        welch.push(chunk);
+        i += chunk.size();
+    }
+    EXPECT_EQ(n_columns, batch.n_segments);
+    EXPECT_EQ(welch.n_segments(), batch.n_segments);
+    expect_near(welch.psd().pxx, batch_psd.pxx, 1e-15);
+}
+
+// --- FIR design ---
+
+TEST(matlab_signal, fir1_unit_gain_and_symmetry)
+{
+    const double one[] = {1.0};
+    const std::pair<matlab::FilterType::V, double> cases[] = {
+      {matlab::FilterType::LowPass{0.3},       0.0                   },
+      {matlab::FilterType::HighPass{0.3},      std::numbers::pi      },
+      {matlab::FilterType::BandPass{0.2, 0.4}, 0.3 * std::numbers::pi},
+      {matlab::FilterType::BandStop{0.2, 0.4}, 0.0                   }
+    };
+    for (const auto& [filter, w0] : cases) {
+        const auto b = matlab::fir1(30, filter);
+        ASSERT_EQ(b.size(), 31u);
+        for (size_t i = 0; i < b.size(); ++i)
+            EXPECT_NEAR(b[i], b[b.size() - 1 - i], 1e-15);
+        EXPECT_NEAR(std::abs(matlab::freqz(b, one, w0)), 1.0, 1e-12);
+    }
+}
+
+TEST(matlab_signal, kaiserord_meets_spec)
+{
+    // Low-pass: passband up to 1000 Hz, stopband from 1500 Hz, fs = 8000 Hz.
+    const double f[] = {1000, 1500};
+    const double a[] = {1, 0};
+    const double dev[] = {0.05, 0.01};
+    const auto ko = matlab::kaiserord(f, a, dev, 8000);
+    // A = 40 dB: beta = 0.5842 * 19^0.4 + 0.07886 * 19, n = ceil((40 - 7.95) / (2.285 * 2 * pi * 500 / 8000)).
+    EXPECT_NEAR(ko.beta, 3.395321052352, 1e-9);
+    EXPECT_EQ(ko.n, 36);
+    ASSERT_TRUE(std::holds_alternative<matlab::FilterType::LowPass>(ko.filter));
+    EXPECT_NEAR(std::get<matlab::FilterType::LowPass>(ko.filter).cutoff, 0.3125, 1e-15);
+
+    const auto b = matlab::fir1(ko.n, ko.filter, matlab::kaiser(ko.n + 1, ko.beta));
+    const double one[] = {1.0};
+    for (double hz = 0; hz <= 4000; hz += 25) {
+        const double m = std::abs(matlab::freqz(b, one, hz / 4000 * std::numbers::pi));
+        // Kaiser's formulas are approximate, allow a small margin.
+        if (hz <= 1000) {
+            EXPECT_NEAR(m, 1.0, 0.06) << hz;
+        } else if (hz >= 1500) {
+            EXPECT_LT(m, 0.012) << hz;
+        }
+    }
+
+    // Filters passing the Nyquist frequency have an even order.
+    const double a_hp[] = {0, 1};
+    const auto ko_hp = matlab::kaiserord(f, a_hp, dev, 8000);
+    EXPECT_TRUE(std::holds_alternative<matlab::FilterType::HighPass>(ko_hp.filter));
+    EXPECT_EQ(ko_hp.n % 2, 0);
+}
+
+#if MEADOW_HAS_EIGEN == 1
+TEST(matlab_signal, firls)
+{
+    // All-pass specification: a delayed impulse.
+    const double f_all[] = {0, 1};
+    const double a_all[] = {1, 1};
+    expect_near(matlab::firls(4, f_all, a_all), {0, 0, 1, 0, 0}, 1e-15);
+
+    // Low-pass with a transition band, odd and even lengths.
+    const double f[] = {0, 0.3, 0.4, 1};
+    const double a[] = {1, 1, 0, 0};
+    const double one[] = {1.0};
+    for (int n : {60, 61}) {
+        const auto b = matlab::firls(n, f, a);
+        ASSERT_EQ(b.size(), static_cast<size_t>(n + 1));
+        for (size_t i = 0; i < b.size(); ++i)
+            EXPECT_NEAR(b[i], b[b.size() - 1 - i], 1e-15);
+        EXPECT_NEAR(std::abs(matlab::freqz(b, one, 0.0)), 1.0, 0.01);
+        EXPECT_NEAR(std::abs(matlab::freqz(b, one, 0.2 * std::numbers::pi)), 1.0, 0.01);
+        EXPECT_LT(std::abs(matlab::freqz(b, one, 0.6 * std::numbers::pi)), 0.01);
+    }
+}
+#endif
+
+TEST(matlab_signal, fir_filter_matches_filter)
+{
+    const auto x = noise_like(5000);
+    const double one[] = {1.0};
+    for (size_t n_taps : {1u, 5u, 63u, 64u, 200u, 1024u}) {
+        const auto b = matlab::fir1(iicast<int>(n_taps + 1), matlab::FilterType::LowPass{0.3});
+        const auto expected = matlab::filter(b, one, x).y;
+        using Method = matlab::FirFilter::Method;
+        for (auto method : {Method::direct, Method::fft, Method::automatic}) {
+            matlab::FirFilter fir(b, method);
+            EXPECT_EQ(
+              fir.uses_fft(),
+              method == Method::fft || (method == Method::automatic && b.size() >= matlab::FirFilter::k_min_fft_taps)
+            );
+            std::vector<double> y(x.size());
+            size_t i = 0;
+            for (size_t block = 1; i < x.size(); block = block * 7 % 3001 + 1) {
+                const size_t m = std::min(block, x.size() - i);
+                if (m == 1) {
+                    y[i] = fir(x[i]);
+                } else {
+                    fir.process(std::span(x).subspan(i, m), std::span(y).subspan(i, m));
+                }
+                i += m;
+            }
+            expect_near(y, expected, 1e-12);
+        }
+    }
+    EXPECT_FALSE(matlab::FirFilter(std::vector<double>(63, 1.0)).uses_fft());
+    EXPECT_TRUE(matlab::FirFilter(std::vector<double>(64, 1.0)).uses_fft());
+}
+
+// --- Resampling ---
+
+namespace
+{
+// upfirdn by definition: zero-stuffing, full-rate convolution, decimation.
+std::vector<double> naive_upfirdn(std::span<const double> x, std::span<const double> h, size_t p, size_t q)
+{
+    std::vector<double> up((x.size() - 1) * p + 1, 0.0);
+    for (size_t i = 0; i < x.size(); ++i)
+        up[i * p] = x[i];
+    std::vector<double> full(up.size() + h.size() - 1, 0.0);
+    for (size_t i = 0; i < up.size(); ++i)
+        for (size_t k = 0; k < h.size(); ++k)
+            full[i + k] += up[i] * h[k];
+    std::vector<double> y;
+    for (size_t i = 0; i < full.size(); i += q)
+        y.push_back(full[i]);
+    return y;
+}
+} // namespace
+
+TEST(matlab_signal, upfirdn)
+{
+    const auto x = noise_like(100);
+    const auto h = matlab::fir1(30, matlab::FilterType::LowPass{0.25});
+    for (int p : {1, 2, 3, 7})
+        for (int q : {1, 2, 5})
+            expect_near(matlab::upfirdn(x, h, p, q), naive_upfirdn(x, h, sucast(p), sucast(q)), 1e-14);
+}
+
+TEST(matlab_signal, resample)
+{
+    // p == q is the identity. Upsampling keeps the original samples, scaled by the center tap of the filter, which
+    // is close to 1 but not exactly after the normalization of the filter.
+    const auto x = noise_like(500);
+    expect_near(matlab::resample(x, 3, 3), x, 1e-15);
+    const auto y2 = matlab::resample(x, 2, 1);
+    ASSERT_EQ(y2.size(), 1000u);
+    const double center_tap = y2[0] / x[0];
+    EXPECT_NEAR(center_tap, 1, 1e-3);
+    for (size_t i = 0; i < x.size(); ++i)
+        EXPECT_NEAR(y2[2 * i], center_tap * x[i], 1e-14);
+
+    // A slow sinusoid, away from the ends.
+    std::vector<double> s(441);
+    for (size_t i = 0; i < s.size(); ++i)
+        s[i] = std::sin(2 * std::numbers::pi * 0.01 * static_cast<double>(i));
+    const auto r = matlab::resample(s, 160, 147); // 44.1 kHz -> 48 kHz
+    ASSERT_EQ(r.size(), 480u);
+    for (size_t i = 100; i < 380; ++i)
+        EXPECT_NEAR(r[i], std::sin(2 * std::numbers::pi * 0.01 * static_cast<double>(i) * 147 / 160), 1e-3);
+
+    // The filter is normalized to a DC gain of p, as in MATLAB: away from the ends, p consecutive outputs of a
+    // constant go through each phase of the filter once, and their mean is the constant.
+    const auto c = matlab::resample(std::vector<double>(300, 2.5), 7, 3);
+    ASSERT_EQ(c.size(), 700u);
+    for (size_t i = 252; i < 448; i += 7)
+        EXPECT_NEAR(matlab::mean(std::span(c).subspan(i, 7)), 2.5, 1e-14);
+}
+
+TEST(matlab_signal, streaming_resampler)
+{
+    const auto x = noise_like(3000);
+    for (auto [p, q] : {std::pair(1, 3), std::pair(3, 2), std::pair(160, 147)}) {
+        const auto expected = matlab::resample(x, p, q);
+        matlab::StreamingResampler resampler(p, q);
+        std::vector<double> y, buffer;
+        size_t i = 0;
+        for (size_t block = 1; i < x.size(); block = block * 5 % 1499 + 1) {
+            const auto chunk = std::span(x).subspan(i, std::min(block, x.size() - i));
+            buffer.resize(resampler.max_output_size(chunk.size()));
+            const size_t n = resampler.process(chunk, buffer);
+            y.insert(y.end(), buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(n));
+            i += chunk.size();
+        }
+        ASSERT_LE(y.size(), expected.size());
+        EXPECT_GT(y.size(), expected.size() * 9 / 10);
+        expect_near(y, std::vector<double>(expected.begin(), expected.begin() + std::ssize(y)), 1e-13);
+    }
+}
+
+// --- Zero-pole-gain conversions ---
+
+TEST(matlab_signal, bilinear_zpk)
+{
+    // H(s) = 1 / (s + 1), fs = 1: H(z) = (1/3) * (z + 1) / (z - 1/3)
+    const matlab::ZeroPoleGain analog{.z = {}, .p = {-1.0}, .k = 1.0};
+    const auto digital = matlab::bilinear_zpk(analog, 1.0, std::nullopt);
+    ASSERT_EQ(digital.z.size(), 1u);
+    ASSERT_EQ(digital.p.size(), 1u);
+    EXPECT_EQ(digital.z[0], -1.0);
+    EXPECT_NEAR(std::abs(digital.p[0] - 1.0 / 3), 0, 1e-15);
+    EXPECT_NEAR(digital.k, 1.0 / 3, 1e-15);
+
+    const auto tf = matlab::zp2tf(digital);
+    expect_near(tf.b, {1.0 / 3, 1.0 / 3}, 1e-15);
+    expect_near(tf.a, {1.0, -1.0 / 3}, 1e-15);
+}
+
+#if MEADOW_HAS_EIGEN == 1
+TEST(matlab_signal, tf2zp_roundtrip)
+{
+    const auto tf = matlab::butter(5, matlab::FilterType::BandPass{0.2, 0.3});
+    const auto back = matlab::zp2tf(matlab::tf2zp(tf.b, tf.a));
+    expect_near(back.b, tf.b, 1e-12);
+    expect_near(back.a, tf.a, 1e-12);
+}
+
+TEST(matlab_signal, bilinear_high_order)
+{
+    // Analog Butterworth low-pass of order 12 with cutoff 1 rad/s, from its poles.
+    const int order = 12;
+    matlab::ZeroPoleGain analog{.z = {}, .p = {}, .k = 1.0};
+    for (int k = 1; k <= order; ++k)
+        analog.p.push_back(std::polar(1.0, std::numbers::pi * (2.0 * k + order - 1) / (2.0 * order)));
+    const auto analog_tf = matlab::zp2tf(analog);
+
+    // The digital response at w must equal the analog one at s = 2 * fs * j * tan(w / 2).
+    const double fs = 2.0;
+    const auto digital = matlab::bilinear(analog_tf.b, analog_tf.a, fs, std::nullopt);
+    for (double w = 0.05; w < 3; w += 0.05) {
+        const std::complex<double> s(0, 2 * fs * std::tan(w / 2));
+        std::complex<double> h_analog = analog.k;
+        for (auto p : analog.p)
+            h_analog /= s - p;
+        EXPECT_NEAR(std::abs(matlab::freqz(digital.b, digital.a, w) - h_analog), 0, 1e-9) << w;
+    }
+}
+#endif
+
+// --- Allocation-free design ---
+
+TEST(matlab_signal, butter_noalloc_matches_butter)
+{
+    const matlab::FilterType::V filters[] = {
+      matlab::FilterType::LowPass{0.2},
+      matlab::FilterType::HighPass{0.35},
+      matlab::FilterType::BandPass{0.1, 0.3},
+      matlab::FilterType::BandStop{0.25, 0.4}
+    };
+    for (const auto& filter : filters) {
+        for (int order = 1; order <= 6; ++order) {
+            const auto expected = matlab::butter(order, filter);
+            const auto tf = matlab::butter_noalloc<12>(order, filter);
+            EXPECT_EQ(std::vector<double>(tf.b.begin(), tf.b.end()), expected.b);
+            EXPECT_EQ(std::vector<double>(tf.a.begin(), tf.a.end()), expected.a);
+        }
+    }
+}
+
+TEST(matlab_signal, bilinear_noalloc_and_poly_noalloc)
+{
+    const double b[] = {1.0, 3.0};
+    const double a[] = {2.0, 5.0, 7.0};
+    const auto expected = matlab::bilinear(b, a, 10.0, 2.0);
+    const auto tf = matlab::bilinear_noalloc<4>(b, a, 10.0, 2.0);
+    // bilinear() transforms the roots when Eigen is available, the noalloc variant expands the polynomials.
+    expect_near(std::vector<double>(tf.b.begin(), tf.b.end()), expected.b, 1e-14);
+    expect_near(std::vector<double>(tf.a.begin(), tf.a.end()), expected.a, 1e-14);
+
+    // (z - 2)(z^2 + 1) = z^3 - 2z^2 + z - 2
+    const std::complex<double> roots[] = {
+      {0, 1 },
+      {2, 0 },
+      {0, -1}
+    };
+    const auto c = matlab::poly_noalloc<5>(roots);
+    EXPECT_EQ(std::vector<double>(c.begin(), c.end()), (std::vector<double>{1, -2, 1, -2}));
+}
+
+// --- Compile-time design ---
+
+namespace
+{
+constexpr auto k_butter4_lp = matlab::butter<4>(matlab::FilterType::LowPass{0.1});
+static_assert(k_butter4_lp.a[0] == 1.0 && k_butter4_lp.b.size() == 5);
+constexpr auto k_butter3_bs = matlab::butter<3>(matlab::FilterType::BandStop{0.2, 0.3});
+static_assert(k_butter3_bs.a.size() == 7);
+
+template<size_t N>
+void expect_static_matches(const matlab::StaticTransferFunctionCoeffs<N>& tf, const matlab::TransferFunctionCoeffs& e)
+{
+    ASSERT_EQ(e.b.size(), N);
+    ASSERT_EQ(e.a.size(), N);
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_NEAR(tf.b[i], e.b[i], 1e-14 * std::max(1.0, std::abs(e.b[i])));
+        EXPECT_NEAR(tf.a[i], e.a[i], 1e-13 * std::max(1.0, std::abs(e.a[i])));
+    }
+}
+} // namespace
+
+TEST(matlab_signal, constexpr_math)
+{
+    for (double x = -7; x <= 7; x += 0.01) {
+        EXPECT_NEAR(cx::sin(x), std::sin(x), 1e-15);
+        EXPECT_NEAR(cx::cos(x), std::cos(x), 1e-15);
+    }
+    for (double x = -1.5; x <= 1.5; x += 0.01)
+        EXPECT_NEAR(cx::tan(x), std::tan(x), 1e-15 * std::max(1.0, std::abs(std::tan(x))));
+    for (double x : {0.0, 1e-300, 1e-10, 0.5, 2.0, 12345.678, 1e300})
+        EXPECT_DOUBLE_EQ(cx::sqrt(x), std::sqrt(x));
+    for (auto z : {std::complex<double>(3, 4), {-3, 4}, {-3, -4}, {-5, 0}, {0, 2}}) {
+        const auto r = cx::sqrt(cx::complex(z.real(), z.imag()));
+        EXPECT_NEAR(r.re, std::sqrt(z).real(), 1e-15);
+        EXPECT_NEAR(r.im, std::sqrt(z).imag(), 1e-15);
+    }
+}
+
+TEST(matlab_signal, butter_constexpr)
+{
+    expect_static_matches(k_butter4_lp, matlab::butter(4, matlab::FilterType::LowPass{0.1}));
+    expect_static_matches(k_butter3_bs, matlab::butter(3, matlab::FilterType::BandStop{0.2, 0.3}));
+    expect_static_matches(
+      matlab::butter<5>(matlab::FilterType::HighPass{0.3}), matlab::butter(5, matlab::FilterType::HighPass{0.3})
+    );
+    expect_static_matches(
+      matlab::butter<2>(matlab::FilterType::BandPass{0.1, 0.4}),
+      matlab::butter(2, matlab::FilterType::BandPass{0.1, 0.4})
+    );
+
+    const auto x = noise_like(300);
+    const auto tf = matlab::butter(4, matlab::FilterType::LowPass{0.1});
+    const auto expected = matlab::filter(tf.b, tf.a, x).y;
+    matlab::StaticIirFilter f(k_butter4_lp);
+    std::vector<double> y(x.size());
+    f.process(x, y);
+    expect_near(y, expected, 1e-13);
+}